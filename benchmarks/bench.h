@@ -0,0 +1,197 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RTML_BENCH_H_
+#define _RTML_BENCH_H_
+
+/**
+ * Helpers shared by the host benchmarks: a monotonic clock, latency
+ * percentiles and histograms, hardware event counters and a barrier to start
+ * threads together.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+inline uint64_t bench_now() {
+  struct timespec n;
+  clock_gettime(CLOCK_MONOTONIC, &n);
+  return (uint64_t)n.tv_sec * 1000000000 + n.tv_nsec;
+}
+
+/**
+ * Keeps latency samples in nanoseconds and prints their percentiles.
+ */
+struct bench_latency {
+  std::vector<uint64_t> samples;
+
+  void reserve(size_t n) { samples.reserve(n); }
+
+  void add(uint64_t ns) { samples.push_back(ns); }
+
+  void merge(const bench_latency &other) {
+    samples.insert(samples.end(), other.samples.begin(), other.samples.end());
+  }
+
+  uint64_t percentile(double p) {
+    if (samples.empty())
+      return 0;
+    std::sort(samples.begin(), samples.end());
+    size_t i = (size_t)(p * (samples.size() - 1));
+    return samples[i];
+  }
+
+  void print(const char *name, unsigned threads) {
+    printf("%-24s threads=%-3u p50=%6luns p99=%8luns p99.9=%8luns "
+           "max=%9luns\n",
+           name, threads, (unsigned long)percentile(0.5),
+           (unsigned long)percentile(0.99), (unsigned long)percentile(0.999),
+           (unsigned long)percentile(1.));
+  }
+
+  /**
+   * Print the number of samples in power of two buckets, from [0, 64ns) up
+   * to the largest sample.
+   */
+  void histogram() {
+    std::vector<size_t> buckets(64, 0);
+    size_t last = 6;
+
+    for (uint64_t s : samples) {
+      size_t b = 6;
+      while (b < 63 && s >= ((uint64_t)1 << b))
+        b++;
+      buckets[b]++;
+      last = std::max(last, b);
+    }
+
+    for (size_t b = 6; b <= last; b++)
+      printf("  <%12luns %9lu\n", (unsigned long)((uint64_t)1 << b),
+             (unsigned long)buckets[b]);
+  }
+};
+
+/**
+ * Counts a hardware event (e.g., PERF_COUNT_HW_CACHE_MISSES) of this process
+ * and of the threads it creates while counting. The counter is not available
+ * when perf events are not permitted (see /proc/sys/kernel/perf_event_paranoid)
+ * or not virtualized.
+ */
+struct bench_counter {
+  int fd;
+
+  explicit bench_counter(uint64_t config) {
+    struct perf_event_attr attr = {};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  }
+
+  ~bench_counter() {
+    if (fd >= 0)
+      close(fd);
+  }
+
+  bool available() const { return fd >= 0; }
+
+  void start() {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  /**
+   * Stops counting and returns the count; counts of inherited threads are
+   * only included once they have been joined.
+   */
+  uint64_t stop() {
+    uint64_t count = 0;
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd, &count, sizeof(count)) != sizeof(count))
+        count = 0;
+    }
+    return count;
+  }
+
+  void print(const char *event, uint64_t count) const {
+    if (available())
+      printf("  %s=%lu\n", event, (unsigned long)count);
+    else
+      printf("  %s=n/a\n", event);
+  }
+};
+
+/**
+ * Allocates an object aligned to A bytes (operator new is only required to
+ * honor over-aligned types since C++17).
+ */
+template <typename O, size_t A, typename... Args>
+O *bench_new_aligned(Args &...args) {
+  void *mem;
+  if (posix_memalign(&mem, A, sizeof(O)))
+    throw std::bad_alloc();
+  return new (mem) O(args...);
+}
+
+template <typename O> void bench_delete_aligned(O *obj) {
+  obj->~O();
+  free(obj);
+}
+
+/**
+ * Runs body(id) on n threads released at the same time.
+ */
+template <typename F> void bench_threads(unsigned n, F body) {
+  std::atomic<unsigned> ready(0);
+  std::vector<std::thread> threads;
+
+  for (unsigned i = 0; i < n; i++)
+    threads.push_back(std::thread([&ready, &body, n, i]() {
+      ready++;
+      while (ready.load() < n)
+        std::this_thread::yield();
+      body(i);
+    }));
+
+  for (auto &t : threads)
+    t.join();
+}
+
+#endif //_RTML_BENCH_H_
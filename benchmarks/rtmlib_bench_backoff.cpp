@@ -0,0 +1,89 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Push latency percentiles and histograms of page swap writers with each
+ * backoff policy on 2 to 16 concurrent writers.
+ */
+
+#include "bench.h"
+
+#include <circularbuffer.h>
+#include <writer.h>
+
+struct pause_policy : RTML_buffer_policy {
+  typedef RTML_pause_backoff backoff;
+};
+
+struct exponential_policy : RTML_buffer_policy {
+  typedef RTML_exponential_backoff<> backoff;
+};
+
+struct spin_yield_policy : RTML_buffer_policy {
+  typedef RTML_spin_yield_backoff<> backoff;
+};
+
+const unsigned pushes = 20000;
+
+template <typename B> void backoff(const char *name, unsigned threads) {
+  B *buf = new B();
+  std::vector<bench_latency> lat(threads);
+
+  // writers must outlive every push since the buffer page may refer to them
+  std::vector<RTML_writer<B> *> writers;
+  for (unsigned i = 0; i < threads; i++)
+    writers.push_back(new RTML_writer<B>(*buf));
+
+  bench_threads(threads, [&](unsigned id) {
+    RTML_writer<B> &writer = *writers[id];
+    Event<int> e = Event<int>(id, 0);
+    lat[id].reserve(pushes);
+
+    for (unsigned i = 0; i < pushes; i++) {
+      uint64_t start = bench_now();
+      writer.push(e);
+      lat[id].add(bench_now() - start);
+    }
+  });
+
+  bench_latency all;
+  for (auto &l : lat)
+    all.merge(l);
+  all.print(name, threads);
+  all.histogram();
+
+  for (auto w : writers)
+    delete w;
+  delete buf;
+}
+
+int main() {
+  for (unsigned threads = 2; threads <= 16; threads *= 2) {
+    backoff<RTML_buffer<Event<int>, 1024>>("yield", threads);
+    backoff<RTML_buffer<Event<int>, 1024, pause_policy>>("pause", threads);
+    backoff<RTML_buffer<Event<int>, 1024, exponential_policy>>("exponential",
+                                                              threads);
+    backoff<RTML_buffer<Event<int>, 1024, spin_yield_policy>>("spin_yield",
+                                                             threads);
+  }
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost of a clock read and of a timestamped push with each clock source, for
+ * one page swap writer, one single producer writer and four contending page
+ * swap writers (where a retry used to read the clock again). Costs are the
+ * mean over all pushes since a per-push sample would pay for a clock read
+ * itself.
+ */
+
+#include "bench.h"
+
+#include <circularbuffer.h>
+#include <writer.h>
+
+// a tick counter kept by the application
+std::atomic<unsigned long> tick_counter(0);
+
+unsigned long tick() {
+  return tick_counter.load(std::memory_order_relaxed);
+}
+
+typedef RTML_tick_clock<unsigned long, tick> tick_clock;
+
+template <typename C> struct clock_policy : RTML_buffer_policy {
+  typedef C clock_source;
+};
+
+template <typename C> struct single_producer_clock_policy : clock_policy<C> {
+  typedef RTML_single_producer writer_protocol;
+};
+
+const unsigned pushes = 1000000;
+const unsigned writers = 4;
+
+template <typename C> double read_cost() {
+  volatile timespan sink = 0;
+  uint64_t start = bench_now();
+  for (unsigned i = 0; i < pushes; i++)
+    sink = C::now();
+  (void)sink;
+  return (double)(bench_now() - start) / pushes;
+}
+
+template <typename B> double push_cost(unsigned threads) {
+  B *buf = new B();
+  std::vector<RTML_writer<B> *> writer;
+  for (unsigned i = 0; i < threads; i++)
+    writer.push_back(new RTML_writer<B>(*buf));
+
+  uint64_t start = bench_now();
+
+  bench_threads(threads, [&](unsigned id) {
+    Event<int> e = Event<int>(id, 0);
+    for (unsigned i = 0; i < pushes / threads; i++)
+      writer[id]->push(e);
+  });
+
+  double cost = (double)(bench_now() - start) / pushes;
+
+  for (auto w : writer)
+    delete w;
+  delete buf;
+
+  return cost;
+}
+
+template <typename C> void clock_source(const char *name) {
+  printf("%-10s read=%6.1fns page_swap=%6.1fns single_producer=%6.1fns "
+         "page_swap(%u)=%6.1fns\n",
+         name, read_cost<C>(),
+         push_cost<RTML_buffer<Event<int>, 1024, clock_policy<C>>>(1),
+         push_cost<
+             RTML_buffer<Event<int>, 1024, single_producer_clock_policy<C>>>(
+             1),
+         writers,
+         push_cost<RTML_buffer<Event<int>, 1024, clock_policy<C>>>(writers));
+}
+
+int main() {
+  RTML_tsc_clock<>::calibrate();
+
+  clock_source<RTML_realtime_clock>("realtime");
+  clock_source<RTML_coarse_clock>("coarse");
+  clock_source<RTML_tsc_clock<>>("tsc");
+  clock_source<tick_clock>("tick");
+
+  return 0;
+}
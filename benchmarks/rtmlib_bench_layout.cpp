@@ -0,0 +1,105 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Push latency and cache misses of the natural and the cache aligned layouts
+ * with 1 to 8 writers and one reader running at the same time.
+ */
+
+#include "bench.h"
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct ticket_policy : RTML_buffer_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+struct ticket_aligned_policy : RTML_cache_aligned_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+const unsigned pushes = 20000;
+
+template <typename B> void layout(const char *name, unsigned threads) {
+  B *buf = bench_new_aligned<B, RTML_CACHE_LINE_SIZE>();
+  std::vector<bench_latency> lat(threads);
+  std::atomic<unsigned> done(0);
+
+  // writers must outlive every push since the buffer page may refer to them
+  std::vector<RTML_writer<B> *> writers;
+  for (unsigned i = 0; i < threads; i++)
+    writers.push_back(bench_new_aligned<RTML_writer<B>, RTML_CACHE_LINE_SIZE>(
+        *buf));
+
+  bench_counter misses(PERF_COUNT_HW_CACHE_MISSES);
+  misses.start();
+
+  // thread 0 reads while the others write
+  bench_threads(threads + 1, [&](unsigned id) {
+    if (id == 0) {
+      RTML_reader<B> reader = RTML_reader<B>(*buf);
+      Event<int> e;
+      while (done.load() < threads)
+        if (reader.pull(e) != reader.AVAILABLE)
+          reader.synchronize();
+      return;
+    }
+
+    RTML_writer<B> &writer = *writers[id - 1];
+    Event<int> e = Event<int>(id, 0);
+    lat[id - 1].reserve(pushes);
+
+    for (unsigned i = 0; i < pushes; i++) {
+      uint64_t start = bench_now();
+      writer.push(e);
+      lat[id - 1].add(bench_now() - start);
+    }
+
+    done++;
+  });
+
+  uint64_t count = misses.stop();
+
+  bench_latency all;
+  for (auto &l : lat)
+    all.merge(l);
+  all.print(name, threads);
+  misses.print("cache-misses", count);
+
+  for (auto w : writers)
+    bench_delete_aligned(w);
+  bench_delete_aligned(buf);
+}
+
+int main() {
+  for (unsigned threads = 1; threads <= 8; threads *= 2) {
+    layout<RTML_buffer<Event<int>, 1024>>("page_swap", threads);
+    layout<RTML_buffer<Event<int>, 1024, RTML_cache_aligned_policy>>(
+        "page_swap aligned", threads);
+    layout<RTML_buffer<Event<int>, 1024, ticket_policy>>("ticket", threads);
+    layout<RTML_buffer<Event<int>, 1024, ticket_aligned_policy>>(
+        "ticket aligned", threads);
+  }
+
+  return 0;
+}
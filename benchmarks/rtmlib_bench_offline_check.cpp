@@ -0,0 +1,111 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Throughput of the offline evaluation of a trace file (see
+ * src/rmtld3/offline.h) with 1 thread and up to one thread per processor.
+ * The formula, a U[9] b nested in U[10], looks 19 time units ahead.
+ */
+
+#include "bench.h"
+
+#include <rmtld3/formulas.h>
+#include <rmtld3/horizon.h>
+#include <rmtld3/offline.h>
+
+typedef Event<proposition> event_t;
+typedef RMTLD3_offline<event_t> offline_t;
+typedef offline_t::trace_t trace_t;
+
+template <typename T> class Eval_inner {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    return prop<T>(trace, 3, t);
+  };
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    return prop<T>(trace, 2, t);
+  };
+};
+
+template <typename T> class Eval_outer {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    return until_less<T, Eval_inner<T>, 9>(trace, t);
+  };
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    return prop<T>(trace, 1, t);
+  };
+};
+
+typedef until_less_h<until_less_h<prop_h, prop_h, 9>, prop_h, 10> compute_h;
+
+three_valued_type compute(trace_t &trace, timespan &t) {
+  return until_less<trace_t, Eval_outer<trace_t>, 10>(trace, t);
+}
+
+const size_t events = 1 << 23;
+
+int main() {
+  char path[] = "/tmp/rtmlib_bench_offline_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0)
+    return 1;
+  close(fd);
+
+  {
+    RTML_trace_recorder<event_t> *recorder =
+        new RTML_trace_recorder<event_t>();
+    if (recorder->create(path) != recorder->OK)
+      return 1;
+    for (size_t i = 0; i < events; i++) {
+      event_t e = event_t((i % 11 == 10) ? 2 : ((i % 13 == 0) ? 1 : 3), i);
+      recorder->append(&e, 1);
+    }
+    recorder->close();
+    delete recorder;
+  }
+
+  RTML_trace_buffer<event_t> trace;
+  if (trace.open(path) != trace.OPENED)
+    return 1;
+
+  unsigned cores = std::thread::hardware_concurrency();
+  for (unsigned threads = 1; threads <= cores || threads == 1;
+       threads *= 2) {
+    size_t runs = 0;
+
+    uint64_t start = bench_now();
+    size_t evaluations = offline_t(trace).check(
+        compute, 0, events, [&runs](const RMTLD3_verdict &) { runs++; },
+        threads, RMTLD3_horizon<compute_h>::future);
+    double s = (bench_now() - start) / 1e9;
+
+    printf("offline_check            threads=%-3u %8.1fMevents/s "
+           "evaluations=%lu runs=%lu\n",
+           threads, events / s / 1e6, (unsigned long)evaluations,
+           (unsigned long)runs);
+  }
+
+  trace.close();
+  unlink(path);
+
+  return 0;
+}
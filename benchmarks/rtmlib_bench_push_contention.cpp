@@ -0,0 +1,86 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Push latency of the page swap and ticket writer protocols with 1 to 16
+ * concurrent writers. Ticket writers that timestamp their events take their
+ * ticket with a compare-and-swap (ticket); push_all takes it with a single
+ * fetch-and-add (ticket_push_all).
+ */
+
+#include "bench.h"
+
+#include <circularbuffer.h>
+#include <writer.h>
+
+struct ticket_policy : RTML_buffer_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+const unsigned pushes = 20000;
+
+template <typename B>
+void contention(const char *name, unsigned threads, bool stamp = true) {
+  B *buf = new B();
+  std::vector<bench_latency> lat(threads);
+
+  // writers must outlive every push since the buffer page may refer to them
+  std::vector<RTML_writer<B> *> writers;
+  for (unsigned i = 0; i < threads; i++)
+    writers.push_back(new RTML_writer<B>(*buf));
+
+  bench_threads(threads, [&](unsigned id) {
+    RTML_writer<B> &writer = *writers[id];
+    Event<int> e = Event<int>(id, 0);
+    lat[id].reserve(pushes);
+
+    for (unsigned i = 0; i < pushes; i++) {
+      timespan t = i;
+      e.setTime(t);
+      uint64_t start = bench_now();
+      if (stamp)
+        writer.push(e);
+      else
+        writer.push_all(e);
+      lat[id].add(bench_now() - start);
+    }
+  });
+
+  bench_latency all;
+  for (auto &l : lat)
+    all.merge(l);
+  all.print(name, threads);
+
+  for (auto w : writers)
+    delete w;
+  delete buf;
+}
+
+int main() {
+  for (unsigned threads = 1; threads <= 16; threads *= 2) {
+    contention<RTML_buffer<Event<int>, 1024>>("page_swap", threads);
+    contention<RTML_buffer<Event<int>, 1024, ticket_policy>>("ticket", threads);
+    contention<RTML_buffer<Event<int>, 1024, ticket_policy>>("ticket_push_all",
+                                                             threads, false);
+  }
+
+  return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Push latency of 1 to 16 concurrent writers sharing one buffer (page swap
+ * and ticket) against writers with a shard each of a RTML_sharded_buffer,
+ * and the cost per event of reading the shards merged by timestamp.
+ */
+
+#include "bench.h"
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/mergereader.h>
+#include <shardedbuffer.h>
+#include <writer.h>
+
+struct ticket_policy : RTML_buffer_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+const unsigned pushes = 20000;
+
+template <typename B> void shared(const char *name, unsigned threads) {
+  B *buf = new B();
+  std::vector<bench_latency> lat(threads);
+
+  // writers must outlive every push since the buffer page may refer to them
+  std::vector<RTML_writer<B> *> writers;
+  for (unsigned i = 0; i < threads; i++)
+    writers.push_back(new RTML_writer<B>(*buf));
+
+  bench_threads(threads, [&](unsigned id) {
+    RTML_writer<B> &writer = *writers[id];
+    Event<int> e = Event<int>(id, 0);
+    lat[id].reserve(pushes);
+
+    for (unsigned i = 0; i < pushes; i++) {
+      uint64_t start = bench_now();
+      writer.push(e);
+      lat[id].add(bench_now() - start);
+    }
+  });
+
+  bench_latency all;
+  for (auto &l : lat)
+    all.merge(l);
+  all.print(name, threads);
+
+  for (auto w : writers)
+    delete w;
+  delete buf;
+}
+
+template <typename S> void sharded(const char *name, unsigned threads) {
+  typedef typename S::shard_t shard_t;
+
+  S *buf = new S();
+  std::vector<bench_latency> lat(threads);
+
+  bench_threads(threads, [&](unsigned id) {
+    RTML_writer<shard_t> writer = RTML_writer<shard_t>(*buf->claim());
+    Event<int> e = Event<int>(id, 0);
+    lat[id].reserve(pushes);
+
+    for (unsigned i = 0; i < pushes; i++) {
+      uint64_t start = bench_now();
+      writer.push(e);
+      lat[id].add(bench_now() - start);
+    }
+  });
+
+  bench_latency all;
+  for (auto &l : lat)
+    all.merge(l);
+  all.print(name, threads);
+
+  // read the merge of the shards once
+  int tzero = 0;
+  RMTLD3_merge_reader<S, int> *trace =
+      new RMTLD3_merge_reader<S, int>(*buf, tzero);
+  trace->synchronize();
+
+  size_t events = trace->length();
+  timespan t;
+  uint64_t start = bench_now();
+  while (trace->read_time(t) == trace->AVAILABLE)
+    trace->advance();
+  uint64_t ns = bench_now() - start;
+
+  printf("%-24s threads=%-3u merged=%lu read=%.1fns/event\n", "merge_read",
+         threads, (unsigned long)events,
+         events ? (double)ns / events : 0.);
+
+  delete trace;
+  delete buf;
+}
+
+int main() {
+  for (unsigned threads = 1; threads <= 16; threads *= 2) {
+    shared<RTML_buffer<Event<int>, 1024>>("page_swap", threads);
+    shared<RTML_buffer<Event<int>, 1024, ticket_policy>>("ticket", threads);
+    sharded<RTML_sharded_buffer<Event<int>, 1024, 16>>("sharded", threads);
+  }
+
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Push latency of one writer with the single producer protocol against the
+ * multi-producer protocols (page swap and ticket), with 0 to 3 readers
+ * running at the same time (threads counts the writer and the readers).
+ */
+
+#include "bench.h"
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct ticket_policy : RTML_buffer_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+struct single_producer_policy : RTML_buffer_policy {
+  typedef RTML_single_producer writer_protocol;
+};
+
+const unsigned pushes = 100000;
+
+template <typename B> void single_writer(const char *name, unsigned readers) {
+  B *buf = new B();
+  RTML_writer<B> *writer = new RTML_writer<B>(*buf);
+  bench_latency lat;
+  std::atomic<bool> done(false);
+
+  // thread 0 writes while the others read
+  bench_threads(readers + 1, [&](unsigned id) {
+    if (id > 0) {
+      RTML_reader<B> reader = RTML_reader<B>(*buf);
+      Event<int> e;
+      while (!done.load())
+        if (reader.pull(e) != reader.AVAILABLE)
+          reader.synchronize();
+      return;
+    }
+
+    Event<int> e = Event<int>(id, 0);
+    lat.reserve(pushes);
+
+    for (unsigned i = 0; i < pushes; i++) {
+      uint64_t start = bench_now();
+      writer->push(e);
+      lat.add(bench_now() - start);
+    }
+
+    done = true;
+  });
+
+  lat.print(name, readers + 1);
+
+  delete writer;
+  delete buf;
+}
+
+int main() {
+  for (unsigned readers = 0; readers <= 3; readers++) {
+    single_writer<RTML_buffer<Event<int>, 1024>>("page_swap", readers);
+    single_writer<RTML_buffer<Event<int>, 1024, ticket_policy>>("ticket",
+                                                                readers);
+    single_writer<RTML_buffer<Event<int>, 1024, single_producer_policy>>(
+        "single_producer", readers);
+  }
+
+  return 0;
+}
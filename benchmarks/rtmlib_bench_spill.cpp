@@ -0,0 +1,98 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Push latency of a writer that overwrites the buffer with and without a
+ * spill file (RTML_file_spill), and the events a reader that synchronizes
+ * once every 10 buffer laps gets and loses.
+ */
+
+#include "bench.h"
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <spill_compat.h>
+#include <writer.h>
+
+struct sequence_policy : RTML_buffer_policy {
+  typedef RTML_single_producer writer_protocol;
+  typedef RTML_sequence_gap gap_detection;
+};
+
+struct spill_policy : sequence_policy {
+  typedef RTML_file_spill spill;
+};
+
+const unsigned pushes = 200000;
+
+template <typename B> void overwrite(const char *name, B *buf) {
+  RTML_writer<B> *writer = new RTML_writer<B>(*buf);
+  RTML_reader<B> reader = RTML_reader<B>(*buf);
+  Event<int> e = Event<int>(0, 0);
+  unsigned long read = 0;
+  bench_latency lat;
+  lat.reserve(pushes);
+
+  for (unsigned i = 0; i < pushes; i++) {
+    uint64_t start = bench_now();
+    writer->push(e);
+    lat.add(bench_now() - start);
+
+    // the reader catches up once every 10 laps
+    if (i % (10 * buf->size_util) == 0) {
+      reader.synchronize();
+      while (reader.pull(e) == reader.AVAILABLE)
+        read++;
+    }
+  }
+
+  lat.print(name, 1);
+  printf("  read=%lu lost=%lu\n", read, (unsigned long)(pushes - read));
+
+  delete writer;
+}
+
+int main() {
+  typedef RTML_buffer<Event<int>, 1024, sequence_policy> plain_t;
+  typedef RTML_buffer<Event<int>, 1024, spill_policy> spill_t;
+
+  plain_t *plain = new plain_t();
+  overwrite("no_spill", plain);
+  delete plain;
+
+  char path[] = "/tmp/rtmlib_bench_spill_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0)
+    return 1;
+  close(fd);
+
+  spill_t *spilled = new spill_t();
+  RTML_spill_file<spill_t> *file = new RTML_spill_file<spill_t>();
+  if (file->create(path, 1 << 16, *spilled) != file->OK)
+    return 1;
+  overwrite("file_spill", spilled);
+
+  delete file;
+  delete spilled;
+  unlink(path);
+
+  return 0;
+}
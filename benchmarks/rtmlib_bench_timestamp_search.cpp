@@ -0,0 +1,162 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Cost of positioning an RMTLD3 reader at a random time (RMTLD3_reader::set)
+ * in buffers of 100 to 1M events: the walk one event at a time, the plain
+ * scan of RTML_event_storage (no bisection) and the bisection of
+ * RTML_event_storage and of RTML_split_storage, whose last window is
+ * scanned by vectors. The kernel
+ * alone (RTML_upper_bound) is compared with the scalar scan on an array of
+ * the same timestamps. Build with -mavx2 (see Makefile) to use AVX2.
+ */
+
+#include "bench.h"
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/reader.h>
+#include <writer.h>
+
+struct split_policy : RTML_buffer_policy {
+  typedef RTML_split_storage storage;
+};
+
+struct scan_policy : RTML_buffer_policy {
+  static const size_t search_window = (size_t)-1;
+};
+
+// the walk of RMTLD3_reader::set one event at a time
+template <typename T> void walk(T &trace, timespan &t) {
+  Event<int> e, ee;
+
+  while (trace.read_previous(e) == trace.AVAILABLE &&
+         trace.read(ee) == trace.AVAILABLE) {
+    if (e.getTime() <= t && t < ee.getTime())
+      return;
+    trace.decrement_cursor();
+  }
+
+  while (trace.read(ee) == trace.AVAILABLE &&
+         trace.read_next(e) == trace.AVAILABLE) {
+    if (ee.getTime() <= t && t < e.getTime())
+      return;
+    trace.increment_cursor();
+  }
+}
+
+template <typename B> struct search {
+  typedef RMTLD3_reader<RTML_reader<B>, int> trace_t;
+
+  B *buf;
+  int tzero;
+  trace_t *trace;
+
+  search() : buf(new B()), tzero(0) {
+    RTML_writer<B> writer = RTML_writer<B>(*buf);
+
+    Event<int> e;
+    for (size_t i = 0; i < buf->size_util; i++) {
+      int d = i;
+      e.set(d, (timespan)i * 10);
+      writer.push_all(e);
+    }
+
+    trace = new trace_t(*buf, tzero);
+    trace->synchronize();
+  }
+
+  ~search() {
+    delete trace;
+    delete buf;
+  }
+
+  // the mean cost of a set from the bottom of the reader
+  template <typename F> double cost(unsigned queries, F set) {
+    srand(1);
+    uint64_t start = bench_now();
+    for (unsigned q = 0; q < queries; q++) {
+      timespan t = (timespan)(rand() % buf->size_util) * 10 + 5;
+      trace->reset();
+      set(*trace, t);
+    }
+    return (double)(bench_now() - start) / queries;
+  }
+};
+
+template <size_t N> void buffer_size() {
+  unsigned queries = (N > 100000) ? 20 : 2000000 / N;
+
+  search<RTML_buffer<Event<int>, N, scan_policy>> scan;
+  search<RTML_buffer<Event<int>, N>> events;
+  search<RTML_buffer<Event<int>, N, split_policy>> split;
+
+  typedef typename search<RTML_buffer<Event<int>, N, scan_policy>>::trace_t
+      scan_t;
+  typedef typename search<RTML_buffer<Event<int>, N>>::trace_t events_t;
+  typedef typename search<RTML_buffer<Event<int>, N, split_policy>>::trace_t
+      split_t;
+
+  double w = events.cost(queries, [](events_t &trace, timespan &t) {
+    walk(trace, t);
+  });
+  double l = scan.cost(queries,
+                       [](scan_t &trace, timespan &t) { trace.set(t); });
+  double e = events.cost(queries,
+                         [](events_t &trace, timespan &t) { trace.set(t); });
+  double s = split.cost(queries,
+                        [](split_t &trace, timespan &t) { trace.set(t); });
+
+  // the kernel on its own over the same timestamps
+  std::vector<timespan> array(N);
+  for (size_t i = 0; i < N; i++)
+    array[i] = (timespan)i * 10;
+  const timespan *times = array.data();
+  std::vector<timespan> keys(queries);
+  srand(1);
+  for (unsigned q = 0; q < queries; q++)
+    keys[q] = (timespan)(rand() % N) * 10 + 5;
+
+  volatile size_t sink = 0;
+  uint64_t start = bench_now();
+  for (unsigned q = 0; q < queries; q++)
+    sink = RTML_upper_bound_scalar(times, N, keys[q]);
+  double scalar = (double)(bench_now() - start) / queries;
+  start = bench_now();
+  for (unsigned q = 0; q < queries; q++)
+    sink = RTML_upper_bound(times, N, keys[q]);
+  double kernel = (double)(bench_now() - start) / queries;
+  (void)sink;
+
+  printf("events=%-8lu walk=%11.0fns scan=%11.0fns event_storage=%8.0fns "
+         "split_storage=%8.0fns scalar=%11.0fns kernel=%11.0fns\n",
+         (unsigned long)N, w, l, e, s, scalar, kernel);
+}
+
+int main() {
+  buffer_size<100>();
+  buffer_size<1000>();
+  buffer_size<10000>();
+  buffer_size<100000>();
+  buffer_size<1000000>();
+
+  return 0;
+}
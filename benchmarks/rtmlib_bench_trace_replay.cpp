@@ -0,0 +1,130 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Throughput of a trace file (see src/trace_compat.h): the recorder writing
+ * it, a reader pulling it from its mapping and a formula evaluated at the
+ * timestamp of each of its events.
+ */
+
+#include "bench.h"
+
+#include <reader.h>
+#include <rmtld3/formulas.h>
+#include <rmtld3/reader.h>
+#include <trace_compat.h>
+
+typedef RTML_trace_buffer<Event<int>> replay_t;
+typedef RTML_reader<replay_t> reader_t;
+typedef RMTLD3_reader<reader_t, int> trace_t;
+
+template <typename T> class Eval_replay {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    proposition p = 1;
+    return prop<T>(trace, p, t);
+  };
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    proposition p = 2;
+    return prop<T>(trace, p, t);
+  };
+};
+
+const size_t events = 1 << 22;
+
+void print(const char *name, uint64_t ns) {
+  double s = ns / 1e9;
+  printf("%-24s events=%lu %8.1fMevents/s %8.1fMB/s\n", name,
+         (unsigned long)events, events / s / 1e6,
+         events * sizeof(Event<int>) / s / 1e6);
+}
+
+int main() {
+  char path[] = "/tmp/rtmlib_bench_trace_XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0)
+    return 1;
+  close(fd);
+
+  {
+    RTML_trace_recorder<Event<int>> *recorder =
+        new RTML_trace_recorder<Event<int>>();
+    Event<int> e[256];
+
+    uint64_t start = bench_now();
+    if (recorder->create(path) != recorder->OK)
+      return 1;
+    for (size_t i = 0; i < events; i += 256) {
+      for (size_t j = 0; j < 256; j++)
+        e[j] = Event<int>((i + j) % 3 + 1, 2 * (i + j));
+      recorder->append(e, 256);
+    }
+    recorder->close();
+    print("record", bench_now() - start);
+
+    delete recorder;
+  }
+
+  replay_t trace;
+  if (trace.open(path) != trace.OPENED)
+    return 1;
+
+  {
+    reader_t reader = reader_t(trace);
+    Event<int> e[256];
+    size_t n, pulled = 0;
+    long sum = 0;
+
+    uint64_t start = bench_now();
+    reader.synchronize();
+    while (reader.pull_n(e, 256, n) == reader.AVAILABLE) {
+      for (size_t i = 0; i < n; i++)
+        sum += e[i].getData();
+      pulled += n;
+    }
+    print("replay_pull_n", bench_now() - start);
+    printf("  pulled=%lu sum=%ld\n", (unsigned long)pulled, sum);
+  }
+
+  {
+    int tzero = 0;
+    trace_t reader = trace_t(trace, tzero);
+    size_t verdicts[3] = {0, 0, 0};
+
+    uint64_t start = bench_now();
+    reader.synchronize();
+    for (size_t i = 0; i < events; i++) {
+      timespan t = 2 * i;
+      reader.set(t);
+      three_valued_type v =
+          until_less<trace_t, Eval_replay<trace_t>, 10>(reader, t);
+      verdicts[v == T_TRUE ? 0 : (v == T_FALSE ? 1 : 2)]++;
+    }
+    print("replay_until_less", bench_now() - start);
+    printf("  true=%lu false=%lu unknown=%lu\n", (unsigned long)verdicts[0],
+           (unsigned long)verdicts[1], (unsigned long)verdicts[2]);
+  }
+
+  trace.close();
+  unlink(path);
+
+  return 0;
+}
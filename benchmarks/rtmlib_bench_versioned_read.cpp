@@ -0,0 +1,105 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Read-side cost of versioned slots: the time per RTML_buffer::read of plain
+ * and versioned slots, for a word-sized and a 64-byte payload, with no writer
+ * and with one concurrent writer.
+ */
+
+#include "bench.h"
+
+#include <circularbuffer.h>
+#include <writer.h>
+
+struct versioned_policy : RTML_buffer_policy {
+  typedef RTML_versioned_slot slot_mode;
+};
+
+struct wide_t {
+  uint64_t word[8];
+
+  bool operator==(const wide_t &other) const {
+    for (int i = 0; i < 8; i++)
+      if (word[i] != other.word[i])
+        return false;
+    return true;
+  }
+};
+
+// keeps the copies from being optimized out
+volatile timespan sink;
+
+const unsigned batches = 2000;
+const unsigned batch = 1000;
+
+template <typename B> void read_cost(const char *name, bool writing) {
+  B *buf = new B();
+  std::atomic<bool> done(false);
+  bench_latency lat;
+  lat.reserve(batches);
+
+  RTML_writer<B> writer = RTML_writer<B>(*buf);
+  typename B::event_t e = typename B::event_t();
+
+  for (size_t i = 0; i < buf->size_util; i++)
+    writer.push(e);
+
+  std::thread w;
+  if (writing)
+    w = std::thread([&]() {
+      typename B::event_t x = typename B::event_t();
+      while (!done.load())
+        writer.push(x);
+    });
+
+  for (unsigned b = 0; b < batches; b++) {
+    uint64_t start = bench_now();
+    for (unsigned i = 0; i < batch; i++) {
+      buf->read(e, i % buf->size);
+      sink = e.getTime();
+    }
+    lat.add((bench_now() - start) / batch);
+  }
+
+  done = true;
+  if (writing)
+    w.join();
+
+  lat.print(name, writing ? 1 : 0);
+
+  delete buf;
+}
+
+int main() {
+  printf("time per read; threads is the number of concurrent writers\n");
+
+  for (int writing = 0; writing < 2; writing++) {
+    read_cost<RTML_buffer<Event<int>, 1024>>("int plain", writing);
+    read_cost<RTML_buffer<Event<int>, 1024, versioned_policy>>(
+        "int versioned", writing);
+    read_cost<RTML_buffer<Event<wide_t>, 1024>>("wide plain", writing);
+    read_cost<RTML_buffer<Event<wide_t>, 1024, versioned_policy>>(
+        "wide versioned", writing);
+  }
+
+  return 0;
+}
@@ -50,6 +50,9 @@ typedef unsigned int uint32_t;
 #define ATOMIC_PAGE()
 #define ATOMIC_PAGE_SWAP()
 
+#define YIELD()
+#define CPU_RELAX()
+
 #define ATOMIC(body)                                                           \
   { body }
 
@@ -92,10 +95,13 @@ typedef unsigned int uint32_t;
 
 #define NATIVE_POINTER_TYPE uint64_t
 #define NATIVE_ATOMIC_POINTER uint64_t
+#define NATIVE_SEQUENCE_TYPE uint64_t
 
 #define YIELD()                                                                \
   { pthread_yield(); }
 
+#define CPU_RELAX() __asm__ __volatile__("nop")
+
 union page_t {
   NATIVE_ATOMIC_POINTER wide_uniqueid;
   struct {
@@ -105,13 +111,13 @@ union page_t {
 
 #define update(page)                                                           \
   {                                                                            \
-    page.stateref = (NATIVE_POINTER_TYPE)stateref;                             \
+    page.stateref = buffer.reference(stateref);                                \
     page;                                                                      \
   }
 
 #define DEBUG_FRAME()                                                          \
   DEBUGV("address:%p content:%p,%lu id:%p\n", &buffer.page,                    \
-         (state_t *)current_page_content.stateref, &state);
+         buffer.resolve(current_page_content), stateref);
 
 /*
  *
@@ -133,10 +139,13 @@ union page_t {
 
 #define NATIVE_POINTER_TYPE uint32_t
 #define NATIVE_ATOMIC_POINTER uint32_t
+#define NATIVE_SEQUENCE_TYPE uint32_t
 
 #define YIELD()                                                                \
   { pthread_yield(); }
 
+#define CPU_RELAX() __asm__ __volatile__("yield")
+
 union page_t {
   NATIVE_ATOMIC_POINTER wide_uniqueid;
   struct {
@@ -146,13 +155,13 @@ union page_t {
 
 #define update(page)                                                           \
   {                                                                            \
-    page.stateref = (NATIVE_POINTER_TYPE)stateref;                             \
+    page.stateref = buffer.reference(stateref);                                \
     page;                                                                      \
   }
 
 #define DEBUG_FRAME()                                                          \
   DEBUGV("address:%p content:%p,%lu id:%p\n", &buffer.page,                    \
-         (state_t *)current_page_content.stateref, &state);
+         buffer.resolve(current_page_content), stateref);
 
 /*
  *
@@ -162,16 +171,22 @@ union page_t {
 #elif defined(__i386__) || defined(__x86_64__)
 
 #include <atomic>
+#include <sched.h>
 
 #if defined(__i386__) && not defined(__x86_64__)
 #define NATIVE_POINTER_TYPE uint32_t
 #define NATIVE_ATOMIC_POINTER uint64_t
+#define NATIVE_SEQUENCE_TYPE uint64_t
 #elif defined(__x86_64__)
 #define NATIVE_POINTER_TYPE uint64_t
 #define NATIVE_ATOMIC_POINTER __int128
+#define NATIVE_SEQUENCE_TYPE uint64_t
+#endif
+
 #define YIELD()                                                                \
   { sched_yield(); }
-#endif
+
+#define CPU_RELAX() __builtin_ia32_pause()
 
 /*
  * This union type is used to split a 64/128 bit wide integer into two equaly
@@ -191,84 +206,111 @@ union page_t {
 #define update(page)                                                           \
   {                                                                            \
     page.counter += 1;                                                         \
-    page.stateref = (NATIVE_POINTER_TYPE)stateref;                             \
+    page.stateref = buffer.reference(stateref);                                \
     page;                                                                      \
   }
 
 #define DEBUG_FRAME()                                                          \
   DEBUGV("address:%p content:%p,%lu id:%p\n", &buffer.page,                    \
-         (state_t *)current_page_content.stateref,                             \
-         current_page_content.counter, &state);
+         buffer.resolve(current_page_content),                                 \
+         current_page_content.counter, stateref);
 
 #endif
 
+/*
+ * The first member aligns the state (and pads its size) to the alignment of
+ * the buffer policy.
+ */
 #define ATOMIC_TYPE()                                                          \
   struct __state {                                                             \
-    size_t top;                                                                \
+    alignas(RTML_alignment<size_t, alignment>::value) size_t top;              \
     size_t bottom;                                                             \
     /* variables that can help to confirm that the last value is ready */      \
     size_t pos;                                                                \
+    /* the number of events pushed (see RTML_sequence_gap) */                  \
+    sequence_t count;                                                          \
+    /* only its writer may complete the push; the next push waits for it */    \
+    bool pending;                                                              \
     event_t event;                                                             \
   };                                                                           \
                                                                                \
   typedef struct __state state_t
 
-#define _bottom()                                                              \
-  ((state_t *)(((page_t)std::atomic_load(&page)).stateref))->bottom
-#define _top() ((state_t *)(((page_t)std::atomic_load(&page)).stateref))->top
+#define _bottom() resolve((page_t)std::atomic_load(&page))->bottom
+#define _top() resolve((page_t)std::atomic_load(&page))->top
+#define _count() resolve((page_t)std::atomic_load(&page))->count
 
 #define ATOMIC_TRIPLE(b, t)                                                    \
-  state_t *s = ((state_t *)(((page_t)std::atomic_load(&page)).stateref));      \
+  state_t *s = resolve((page_t)std::atomic_load(&page));                       \
   b = s->bottom;                                                               \
   t = s->top;
 
 #define ATOMIC_PAGE()                                                          \
   state_t state_global = {                                                     \
-      .top = 0, .bottom = 0, .pos = 0, .event = event_t()};                    \
-  std::atomic<page_t> page =                                                   \
-      ATOMIC_VAR_INIT({(NATIVE_POINTER_TYPE)&state_global})
+      .top = 0,                                                                \
+      .bottom = 0,                                                             \
+      .pos = 0,                                                                \
+      .count = 0,                                                              \
+      .pending = false,                                                        \
+      .event = event_t()};                                                     \
+  alignas(RTML_alignment<std::atomic<page_t>, alignment>::value)               \
+      std::atomic<page_t> page =                                               \
+          ATOMIC_VAR_INIT({reference(&state_global)})
 
+/*
+ * Each writer owns two states and alternates between them; the state that is
+ * not referenced by the page is never read by other writers, so a preempted
+ * writer can not corrupt the state published by another writer.
+ */
 #define ATOMIC_PAGE_SWAP()                                                     \
   typedef typename B::state_t state_t;                                         \
-  state_t state;                                                               \
-  state_t *stateref = &state;
+  state_t state[2];                                                            \
+  state_t *stateref = &state[0];
 
 #define ATOMIC_PUSH(body)                                                      \
   bool fail = false;                                                           \
   page_t current_page_content, new_page_content;                               \
   typename B::event_t evt;                                                     \
+  typename B::backoff_t backoff;                                               \
+  /* the two states of this writer (see RTML_relative_address) */              \
+  state_t *own = states(typename B::address_mode());                           \
   do {                                                                         \
     if (fail) {                                                                \
-      /* do a yield here */                                                    \
-      YIELD();                                                                 \
+      /* back off before the next attempt (see RTML_buffer_policy) */          \
+      backoff.wait();                                                          \
       fail = false;                                                            \
     }                                                                          \
                                                                                \
+  /* give a chance to complete the last push if it is not ready yet; the */    \
+  /* page is loaded again since the state it refers to may be reused */        \
+  complete:                                                                    \
     current_page_content = (page_t)std::atomic_load(&buffer.page);             \
     new_page_content = current_page_content;                                   \
                                                                                \
-  /* give a chance to complete the last push if it is not ready yet */         \
-  complete:                                                                    \
-    buffer.read(evt, ((state_t *)current_page_content.stateref)->pos);         \
-    DEBUGV("%lu\n", ((state_t *)current_page_content.stateref)->pos);          \
-    if (!(((state_t *)current_page_content.stateref)->event == evt)) {         \
-      /* do a yield here */                                                    \
-      YIELD();                                                                 \
+    buffer.read(evt, buffer.resolve(current_page_content)->pos);               \
+    DEBUGV("%lu\n", buffer.resolve(current_page_content)->pos);                \
+    if (buffer.resolve(current_page_content)->pending ||                       \
+        !(buffer.resolve(current_page_content)->event == evt)) {               \
+      /* finish the last push or wait for it (see RTML_buffer_policy) */       \
+      if (!help(current_page_content, typename B::completion_t()))             \
+        backoff.wait();                                                        \
       goto complete;                                                           \
     }                                                                          \
                                                                                \
-    if (&state == (state_t *)current_page_content.stateref) {                  \
-      /* current state is in use; use buffer state */                          \
-      stateref = (state_t *)&buffer.state_global;                              \
+    if (&own[0] == buffer.resolve(current_page_content)) {                     \
+      /* current state is in use; use the other state */                       \
+      stateref = &own[1];                                                      \
     } else {                                                                   \
       /* use current state */                                                  \
-      stateref = (state_t *)&state;                                            \
+      stateref = &own[0];                                                      \
     }                                                                          \
                                                                                \
     /* copy state */                                                           \
-    stateref->bottom = ((state_t *)current_page_content.stateref)->bottom;     \
-    stateref->top = ((state_t *)current_page_content.stateref)->top;           \
+    stateref->bottom = buffer.resolve(current_page_content)->bottom;           \
+    stateref->top = buffer.resolve(current_page_content)->top;                 \
+    stateref->count = buffer.resolve(current_page_content)->count;             \
     stateref->pos = stateref->top;                                             \
+    stateref->pending = false;                                                 \
                                                                                \
     body;                                                                      \
                                                                                \
@@ -0,0 +1,1089 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RTML_BUFFER_POLICY_H_
+#define _RTML_BUFFER_POLICY_H_
+
+#include "atomic_compat.h"
+#include "clock_compat.h"
+#include "notify_compat.h"
+#include "search_compat.h"
+
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * Writer protocol where each push copies the buffer state, updates it and
+ * swaps the page of the buffer with a compare-and-swap (see ATOMIC_PUSH). A
+ * writer that loses the race retries the whole push.
+ */
+struct RTML_page_swap {};
+
+/**
+ * Writer protocol where each push reserves its slot on a sequence counter
+ * (the ticket) and then publishes the slot on its own; readers see the
+ * longest prefix of published tickets.
+ *
+ * A push that timestamps its event reads the clock and takes the ticket with
+ * a compare-and-swap, and reads the clock again when another writer took it
+ * first, so timestamps follow the order of the tickets. Such pushes are
+ * lock-free but not wait-free: a writer retries while other writers keep
+ * taking tickets. Pushes of events that are already timestamped (push_all)
+ * take their ticket with a single fetch-and-add and are wait-free.
+ *
+ * A writer waits until the writer of the previous lap of its slot has
+ * published it, so a writer preempted for a whole lap of the ring stalls the
+ * writer that laps it. The ticket protocol requires RTML_plain_slot.
+ */
+struct RTML_ticket {};
+
+/**
+ * Writer protocol for buffers written by a single writer (SPSC or SPMC). The
+ * writer owns the top of the buffer, so a push writes its slot and publishes
+ * it with a single release store of the top; there is no compare-and-swap and
+ * no retry. Only the first RTML_writer attached to the buffer may push; any
+ * other writer gets UNSAFE and writes nothing.
+ */
+struct RTML_single_producer {};
+
+/**
+ * Index mode where the indices of the ring wrap around its end with a compare
+ * and branch. Any capacity is supported.
+ */
+struct RTML_wrapped_index {};
+
+/**
+ * Index mode where the indices of the ring wrap around its end with a mask.
+ * The number of slots (N + 1) must be a power of two, e.g.,
+ * RTML_buffer<T, 1023, P>, so that the length is a subtraction and the reader
+ * and writer loops have no wrap branches.
+ */
+struct RTML_masked_index {};
+
+/**
+ * Index arithmetic of a ring with S slots for the index mode M. Indices are
+ * always in [0, S) and counts are at most S.
+ */
+template <size_t S, typename M> struct RTML_index {
+  static size_t next(size_t i) { return (i + 1 >= S) ? 0 : i + 1; }
+
+  static size_t prev(size_t i) { return (i == 0) ? S - 1 : i - 1; }
+
+  static size_t advance(size_t i, size_t n) {
+    return (i + n >= S) ? i + n - S : i + n;
+  }
+
+  static size_t retreat(size_t i, size_t n) {
+    return (i >= n) ? i - n : S - (n - i);
+  }
+
+  /**
+   * The number of slots from b up to t
+   */
+  static size_t distance(size_t b, size_t t) {
+    return (t >= b) ? t - b : S - (b - t);
+  }
+
+  /**
+   * The slot of a free-running sequence number
+   */
+  template <typename C> static size_t slot(C seq) { return seq % S; }
+};
+
+template <size_t S> struct RTML_index<S, RTML_masked_index> {
+  static_assert(S > 0 && (S & (S - 1)) == 0,
+                "RTML_masked_index requires N + 1 to be a power of two");
+
+  static const size_t mask = S - 1;
+
+  static size_t next(size_t i) { return (i + 1) & mask; }
+
+  static size_t prev(size_t i) { return (i - 1) & mask; }
+
+  static size_t advance(size_t i, size_t n) { return (i + n) & mask; }
+
+  static size_t retreat(size_t i, size_t n) { return (i - n) & mask; }
+
+  static size_t distance(size_t b, size_t t) { return (t - b) & mask; }
+
+  template <typename C> static size_t slot(C seq) { return seq & mask; }
+};
+
+/**
+ * Gap detection where readers compare the timestamp of the next event with the
+ * timestamp of the last event they have read. A gap may go unnoticed when
+ * timestamps repeat, and readers keep one event unread to look ahead.
+ */
+struct RTML_timestamp_gap {};
+
+/**
+ * Gap detection where each slot carries the sequence number of its event, i.e.
+ * the number of events pushed before it plus one (zero if the slot has not
+ * been written). Readers detect gaps and count lost events exactly, without
+ * looking ahead.
+ */
+struct RTML_sequence_gap {};
+
+/**
+ * Slot mode where events are copied in and out of the slots without any
+ * protection. A reader may copy an event while a writer overwrites it, which
+ * tears events wider than the native word.
+ */
+struct RTML_plain_slot {};
+
+/**
+ * Slot mode where each slot has a version that is odd while the slot is
+ * written (a seqlock per slot). RTML_buffer::read retries a copy that
+ * overlaps a write and reports the slot as TORN after read_retries attempts.
+ * A slot must not be written by two writers at the same time, so this mode
+ * supports neither RTML_help_completion nor RTML_ticket.
+ */
+struct RTML_versioned_slot {};
+
+/**
+ * Storage where each slot keeps a whole event, timestamp and payload side by
+ * side. Events can be built in place in their slots.
+ */
+struct RTML_event_storage {};
+
+/**
+ * Storage where each slot keeps the low bits of the timestamp (a D, e.g.,
+ * uint16_t or uint32_t) next to the payload, and each block of B slots keeps
+ * the full timestamp of its first slot as the base of the lap. A timestamp is
+ * rebuilt from the base and the D-bit delta modulo 2^bits (wrap-aware), so
+ * the events of a block must be less than 2^(bits - 1) time units after its
+ * first one, e.g., 32767us with 16-bit deltas of a microsecond clock (see
+ * RTML_tick_clock). Writers reject an event beyond the bound with
+ * OUT_OF_BOUND before it is published, so D and the clock must cover the
+ * longest gap between the events of a block. A ticket writer can not reject
+ * the slot it holds, so RTML_ticket is not supported. An Event<uint8_t>
+ * takes 4 bytes with 16-bit deltas instead of 16.
+ *
+ * Events are rebuilt on each copy, so they cannot be built in place; writers
+ * build reserved events aside and copy them into the slot on commit.
+ */
+template <typename D = uint32_t, size_t B = 32> struct RTML_delta_storage {};
+
+/**
+ * Storage where the timestamps and the payloads of the slots are kept in two
+ * separate arrays (struct of arrays). Searches by time touch only the array
+ * of timestamps (see RTML_buffer::read_time), which is contiguous and can be
+ * scanned with vector instructions. Events are copied field by field, so they
+ * cannot be built in place either.
+ */
+struct RTML_split_storage {};
+
+/**
+ * Spill where the events overwritten in the buffer are lost to the readers
+ * that have not read them yet.
+ */
+struct RTML_no_spill {};
+
+/**
+ * Spill where writers copy the event of a slot to a ring of records in a
+ * memory-mapped file (see RTML_spill_file) before overwriting the slot. The
+ * record of an event is found by its sequence number, so a reader behind the
+ * buffer reads the events it missed from the file instead of losing them,
+ * as long as the file has not overwritten them in turn. It requires
+ * RTML_sequence_gap. The buffer refers to the mapping by its address, so it
+ * can not be shared between processes (see RTML_shared_buffer).
+ *
+ * Writers skip an event that changes while it is copied, e.g., when a page
+ * swap writer is preempted for a whole lap of the ring.
+ */
+struct RTML_file_spill {};
+
+/**
+ * Check the spill S against the gap detection G
+ */
+template <typename S, typename G> struct RTML_spill_gap {
+  static const bool valid = true;
+};
+
+template <> struct RTML_spill_gap<RTML_file_spill, RTML_timestamp_gap> {
+  static const bool valid = false;
+};
+
+/**
+ * Check the storage S against the writer protocol W
+ */
+template <typename S, typename W> struct RTML_storage_protocol {
+  static const bool valid = true;
+};
+
+template <typename D, size_t B>
+struct RTML_storage_protocol<RTML_delta_storage<D, B>, RTML_ticket> {
+  static const bool valid = false;
+};
+
+/**
+ * Address mode where the page of the buffer refers to the state of a page
+ * swap writer by its address and each RTML_writer keeps its own states. The
+ * buffer is only meaningful in the address space of the process that built
+ * it.
+ */
+struct RTML_absolute_address {};
+
+/**
+ * Address mode where the page of the buffer refers to writer states by their
+ * offset from the buffer, and the states of up to W page swap writers are
+ * kept in the buffer itself. The buffer holds no pointer, so it can live in a
+ * shared memory segment mapped at different addresses by several processes
+ * (see RTML_shared_buffer). A writer attached after the first W gets UNSAFE.
+ */
+template <unsigned W = 8> struct RTML_relative_address {};
+
+/**
+ * Completion where a page swap writer waits (see the backoff of the policy)
+ * until the last pushed event is written by its writer. A writer preempted
+ * between publishing its state and writing its event stalls every other
+ * writer until it runs again.
+ */
+struct RTML_wait_completion {};
+
+/**
+ * Completion where a page swap writer that finds the last pushed event not
+ * written yet writes it on behalf of its writer, from the copy of the event in
+ * the published state. A preempted writer then delays no other writer; when
+ * it runs again it skips its own write once the page has moved on. Bursts and
+ * reservations are still waited for, since their events are not in the state.
+ *
+ * Each slot is claimed by the push it is written for (see RTML_slot_claim),
+ * so a helper that resumes after the ring has lapped the slot skips its copy
+ * instead of overwriting a newer event; the writer of the later lap waits
+ * while such a copy is still in progress. The helper and the writer may
+ * write the same slot at the same time, so this completion requires
+ * RTML_plain_slot.
+ */
+struct RTML_help_completion {};
+
+/**
+ * Check the slot mode M against the completion C
+ */
+template <typename C, typename M> struct RTML_completion_slot {
+  static const bool valid = true;
+};
+
+template <> struct RTML_completion_slot<RTML_help_completion,
+                                        RTML_versioned_slot> {
+  static const bool valid = false;
+};
+
+/**
+ * Check the slot mode M against the writer protocol W
+ */
+template <typename M, typename W> struct RTML_slot_protocol {
+  static const bool valid = true;
+};
+
+template <> struct RTML_slot_protocol<RTML_versioned_slot, RTML_ticket> {
+  static const bool valid = false;
+};
+
+/**
+ * Backoff of a page swap writer that waits for the push of another writer,
+ * either after losing the compare-and-swap or while the last pushed event is
+ * not written yet. The writer yields the processor each time, which is the
+ * cheapest wait when writers share a core; under SCHED_FIFO a yield only lets
+ * writers of the same priority run.
+ */
+struct RTML_yield_backoff {
+  void wait() { YIELD(); }
+};
+
+/**
+ * Backoff where the writer spins with the pause instruction of the processor
+ * and never leaves it. It suits writers on their own cores; a writer that
+ * shares its core with the writer it waits for spins until it is preempted.
+ */
+struct RTML_pause_backoff {
+  void wait() { CPU_RELAX(); }
+};
+
+/**
+ * Backoff where the writer spins 1, 2, 4, ... up to Max pause instructions
+ * between consecutive attempts of the same push, so contending writers spread
+ * their attempts apart.
+ */
+template <unsigned Max = 1024> struct RTML_exponential_backoff {
+  unsigned spins;
+
+  RTML_exponential_backoff() : spins(1) {}
+
+  void wait() {
+    for (unsigned i = 0; i < spins; i++)
+      CPU_RELAX();
+
+    if (spins < Max)
+      spins *= 2;
+  }
+};
+
+/**
+ * Backoff where the writer spins with the pause instruction for the first
+ * Spins waits of a push and yields the processor afterwards. Short waits stay
+ * on the core while a preempted writer is given a chance to run.
+ */
+template <unsigned Spins = 64> struct RTML_spin_yield_backoff {
+  unsigned waits;
+
+  RTML_spin_yield_backoff() : waits(0) {}
+
+  void wait() {
+    if (waits < Spins) {
+      waits++;
+      CPU_RELAX();
+    } else
+      YIELD();
+  }
+};
+
+/*
+ * The size of the cache line used by the cache aligned layout; define it
+ * before the first include to target another architecture.
+ */
+#ifndef RTML_CACHE_LINE_SIZE
+#define RTML_CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * The alignment of a member of type T in a layout aligned to A bytes. It is
+ * never weaker than the natural alignment of T.
+ */
+template <typename T, size_t A> struct RTML_alignment {
+  static const size_t value = (A > alignof(T)) ? A : alignof(T);
+};
+
+/**
+ * Default policy of RTML_buffer. Other policies are defined by deriving from
+ * this structure and shadowing its members, e.g.,
+ *
+ * \code
+ * struct ticket_policy : RTML_buffer_policy {
+ *   typedef RTML_ticket writer_protocol;
+ * };
+ *
+ * RTML_buffer<Event<int>, 100, ticket_policy> buf;
+ * \endcode
+ */
+struct RTML_buffer_policy {
+  /**
+   * The protocol used by RTML_writer to push events
+   */
+  typedef RTML_page_swap writer_protocol;
+
+  /**
+   * The alignment in bytes of the control block, the slot array and the
+   * writer states (1 keeps the natural layout)
+   */
+  static const size_t alignment = 1;
+
+  /**
+   * The index arithmetic of the ring (RTML_wrapped_index or
+   * RTML_masked_index)
+   */
+  typedef RTML_wrapped_index index_mode;
+
+  /**
+   * The gap detection of readers (RTML_timestamp_gap or RTML_sequence_gap)
+   */
+  typedef RTML_timestamp_gap gap_detection;
+
+  /**
+   * The protection of slot copies (RTML_plain_slot or RTML_versioned_slot)
+   */
+  typedef RTML_plain_slot slot_mode;
+
+  /**
+   * The attempts to read a versioned slot before it is reported as TORN
+   */
+  static const unsigned read_retries = 8;
+
+  /**
+   * The wait of page swap writers under contention (RTML_yield_backoff,
+   * RTML_pause_backoff, RTML_exponential_backoff or RTML_spin_yield_backoff)
+   */
+  typedef RTML_yield_backoff backoff;
+
+  /**
+   * How page swap writers complete the last push of another writer
+   * (RTML_wait_completion or RTML_help_completion)
+   */
+  typedef RTML_wait_completion completion;
+
+  /**
+   * How the page refers to writer states (RTML_absolute_address or
+   * RTML_relative_address)
+   */
+  typedef RTML_absolute_address address_mode;
+
+  /**
+   * How writers wake blocked readers (RTML_no_notification or
+   * RTML_wakeup_notification)
+   */
+  typedef RTML_no_notification notification;
+
+  /**
+   * Writers notify the readers once every watermark events (see
+   * RTML_wakeup_notification)
+   */
+  static const size_t watermark = 1;
+
+  /**
+   * Check if pushing the event notifies the readers regardless of the
+   * watermark, e.g., when it holds a given proposition
+   */
+  template <typename E> static bool urgent(const E &) { return false; }
+
+  /**
+   * How the slots keep events (RTML_event_storage, RTML_delta_storage or
+   * RTML_split_storage)
+   */
+  typedef RTML_event_storage storage;
+
+  /**
+   * Searches by time (see RTML_buffer::upper_bound) bisect the events until
+   * at most search_window of them are left and scan these
+   */
+  static const size_t search_window = 64;
+
+  /**
+   * What happens to the overwritten events (RTML_no_spill or
+   * RTML_file_spill)
+   */
+  typedef RTML_no_spill spill;
+
+  /**
+   * The clock that timestamps pushed events (RTML_realtime_clock,
+   * RTML_coarse_clock, RTML_tsc_clock or RTML_tick_clock)
+   */
+  typedef RTML_realtime_clock clock_source;
+};
+
+/**
+ * Policy that places the hot fields of the buffer in their own cache lines so
+ * that writers and readers do not share lines with each other. The slot
+ * array, the page, the control block and each writer state start at a cache
+ * line and are padded to a multiple of it.
+ *
+ * \code
+ * struct ticket_aligned_policy : RTML_cache_aligned_policy {
+ *   typedef RTML_ticket writer_protocol;
+ * };
+ * \endcode
+ */
+struct RTML_cache_aligned_policy : RTML_buffer_policy {
+  static const size_t alignment = RTML_CACHE_LINE_SIZE;
+};
+
+/**
+ * Versions of the S slots of a RTML_buffer for the slot mode M, aligned to A
+ * bytes. Without versions every copy is valid.
+ */
+template <size_t S, typename M, size_t A = 1> struct RTML_slot_version {
+  void begin_write(size_t) {}
+
+  void end_write(size_t) {}
+
+  size_t begin_read(size_t) const { return 0; }
+
+  bool validate(size_t, size_t) const { return true; }
+};
+
+/**
+ * The S slots of a RTML_buffer of events T for the storage M, aligned to A
+ * bytes. The whole events are kept in an array.
+ */
+template <typename T, size_t S, typename M, size_t A = 1>
+struct RTML_slot_storage {
+  alignas(RTML_alignment<T, A>::value) T array[S];
+
+  T &at(size_t index) { return array[index]; }
+
+  void put(size_t index, const T &event) { array[index] = event; }
+
+  void get(T &event, size_t index) const { event = array[index]; }
+
+  /**
+   * Copy count consecutive slots from the index (without wrapping)
+   */
+  void put(size_t index, const T *events, size_t count) {
+    MEMCPY(&array[index], events, count * sizeof(T));
+  }
+
+  void get(T *events, size_t index, size_t count) const {
+    MEMCPY(events, &array[index], count * sizeof(T));
+  }
+
+  timespan time(size_t index) const { return array[index].getTime(); }
+
+  /**
+   * Check if the count events can be put in consecutive slots from the index
+   * (without wrapping) and keep their timestamps
+   */
+  bool fits(size_t, const T *, size_t) const { return true; }
+
+  /**
+   * Get the number of the count consecutive slots from the index (without
+   * wrapping) whose non-decreasing timestamps are up to t
+   */
+  size_t upper_bound(size_t index, size_t count, const timespan &t) const {
+    size_t i = 0;
+    while (i < count && array[index + i].getTime() <= t)
+      i++;
+    return i;
+  }
+};
+
+template <typename T, size_t S, typename D, size_t B, size_t A>
+struct RTML_slot_storage<T, S, RTML_delta_storage<D, B>, A> {
+  typedef typename T::data_t data_t;
+
+  /**
+   * The low bits of the timestamp are its difference to the base modulo
+   * 2^bits; they do not depend on the base, so the base may change later
+   */
+  struct slot_t {
+    D low;
+    uint8_t lap;
+    data_t data;
+  };
+
+  static const size_t blocks = (S + B - 1) / B;
+
+  /**
+   * The bases of each block for the current and the previous lap; the slots
+   * of the previous lap that have not been overwritten yet keep their base
+   */
+  alignas(RTML_alignment<timespan, A>::value) timespan base[blocks][2];
+
+  /**
+   * The lap of the base set last in each block (0 or 1)
+   */
+  uint8_t lap[blocks];
+
+  alignas(RTML_alignment<slot_t, A>::value) slot_t array[S];
+
+  RTML_slot_storage() : base(), lap(), array() {}
+
+  void put(size_t index, const T &event) {
+    size_t k = index / B;
+
+    if (index % B == 0) {
+      *(volatile timespan *)&base[k][lap[k] ^ 1] = event.getTime();
+      *(volatile uint8_t *)&lap[k] ^= 1;
+    }
+
+    array[index].low = (D)event.getTime();
+    array[index].lap = lap[k];
+    array[index].data = event.getData();
+  }
+
+  void get(T &event, size_t index) const {
+    data_t data = array[index].data;
+    timespan t = time(index);
+    event.set(data, t);
+  }
+
+  void put(size_t index, const T *events, size_t count) {
+    for (size_t i = 0; i < count; i++)
+      put(index + i, events[i]);
+  }
+
+  void get(T *events, size_t index, size_t count) const {
+    for (size_t i = 0; i < count; i++)
+      get(events[i], index + i);
+  }
+
+  /**
+   * Rebuild the timestamp of the slot from the base of its block and lap.
+   * The base is read again in case it has been set meanwhile (a 64-bit base
+   * may be torn on 32-bit targets).
+   */
+  timespan time(size_t index) const {
+    const volatile timespan *b = &base[index / B][array[index].lap];
+    timespan t;
+    D low;
+
+    do {
+      t = *b;
+      low = array[index].low;
+    } while (t != *b);
+
+    return rebuild(t, low);
+  }
+
+  /**
+   * Rebuild a timestamp from a base and its low bits, i.e., the shortest way
+   * around the circle of 2^bits from the base to the low bits
+   */
+  static timespan rebuild(const timespan &t, D low) {
+    D forward = (D)(low - (D)t);
+    D backward = (D)((D)t - low);
+
+    return (forward <= backward) ? t + (timespan)forward
+                                 : t - (timespan)backward;
+  }
+
+  /**
+   * The first slot of a block sets its base; any other slot must be rebuilt
+   * from the base of the lap that is set last. A writer checks its events
+   * before they are published, once the slots before them are written.
+   */
+  bool fits(size_t index, const T *events, size_t count) const {
+    timespan t = base[index / B][lap[index / B]];
+
+    for (size_t i = 0; i < count; i++, index++) {
+      timespan e = events[i].getTime();
+
+      if (index % B == 0)
+        t = e;
+      else if (rebuild(t, (D)e) != e)
+        return false;
+    }
+
+    return true;
+  }
+
+  size_t upper_bound(size_t index, size_t count, const timespan &t) const {
+    size_t i = 0;
+    while (i < count && time(index + i) <= t)
+      i++;
+    return i;
+  }
+};
+
+template <typename T, size_t S, size_t A>
+struct RTML_slot_storage<T, S, RTML_split_storage, A> {
+  typedef typename T::data_t data_t;
+
+  alignas(RTML_alignment<timespan, A>::value) timespan times[S];
+
+  alignas(RTML_alignment<data_t, A>::value) data_t data[S];
+
+  RTML_slot_storage() : times(), data() {}
+
+  void put(size_t index, const T &event) {
+    times[index] = event.getTime();
+    data[index] = event.getData();
+  }
+
+  void get(T &event, size_t index) const {
+    data_t d = data[index];
+    event.set(d, times[index]);
+  }
+
+  void put(size_t index, const T *events, size_t count) {
+    for (size_t i = 0; i < count; i++)
+      times[index + i] = events[i].getTime();
+    for (size_t i = 0; i < count; i++)
+      data[index + i] = events[i].getData();
+  }
+
+  void get(T *events, size_t index, size_t count) const {
+    for (size_t i = 0; i < count; i++)
+      get(events[i], index + i);
+  }
+
+  timespan time(size_t index) const { return times[index]; }
+
+  bool fits(size_t, const T *, size_t) const { return true; }
+
+  /**
+   * The timestamps are contiguous, so they are compared by vectors (see
+   * RTML_upper_bound)
+   */
+  size_t upper_bound(size_t index, size_t count, const timespan &t) const {
+    return RTML_upper_bound(times + index, count, t);
+  }
+};
+
+/**
+ * Control block kept by a RTML_buffer of S slots for the writer protocol W,
+ * with its counters aligned to A bytes. The page swap protocol keeps its state
+ * in the ATOMIC_PAGE of the buffer.
+ */
+template <size_t S, typename W, size_t A = 1> struct RTML_protocol_control {};
+
+#ifndef __HW__
+
+/*
+ * NATIVE_SEQUENCE_TYPE is the widest counter the architecture increments
+ * with a lock-free fetch-and-add (64-bit except on ARM32).
+ */
+typedef NATIVE_SEQUENCE_TYPE sequence_t;
+
+template <size_t S, size_t A> struct RTML_protocol_control<S, RTML_ticket, A> {
+  typedef std::atomic<sequence_t> counter_t;
+
+  /**
+   * The next ticket to be reserved by a writer
+   */
+  alignas(RTML_alignment<counter_t, A>::value) counter_t reserve;
+
+  /**
+   * Every ticket below commit has been published. It is only a hint that
+   * readers move forward; the slot sequences are the reference.
+   */
+  alignas(RTML_alignment<counter_t, A>::value) mutable counter_t commit;
+
+  /**
+   * Every ticket below drop has been consumed with RTML_buffer::pull
+   */
+  alignas(RTML_alignment<counter_t, A>::value) counter_t drop;
+
+  /**
+   * The last ticket published at each slot plus one (zero if none)
+   */
+  alignas(RTML_alignment<counter_t, A>::value) counter_t seq[S];
+
+  RTML_protocol_control() {
+    reserve.store(0);
+    commit.store(0);
+    drop.store(0);
+    for (size_t i = 0; i < S; i++)
+      seq[i].store(0);
+  }
+
+  /**
+   * Check if the ticket of the previous lap of the slot of a ticket has been
+   * published, i.e. no other writer still writes the slot
+   */
+  bool ready(sequence_t ticket) const {
+    return seq[ticket % S].load(std::memory_order_acquire) + S > ticket;
+  }
+
+  /**
+   * Publish a ticket. A writer that has been lapped while writing does not
+   * move the slot sequence backwards.
+   */
+  void publish(sequence_t ticket) {
+    sequence_t s = seq[ticket % S].load(std::memory_order_relaxed);
+    while (s < ticket + 1 && !seq[ticket % S].compare_exchange_weak(
+                                 s, ticket + 1, std::memory_order_release,
+                                 std::memory_order_relaxed))
+      ;
+  }
+
+  /**
+   * Get the first ticket that is not published yet. Tickets that have been
+   * overwritten by a later lap count as published.
+   */
+  sequence_t committed() const {
+    sequence_t c = commit.load(std::memory_order_acquire);
+    sequence_t n = c;
+
+    while (seq[n % S].load(std::memory_order_acquire) > n)
+      ++n;
+
+    while (c < n && !commit.compare_exchange_weak(c, n,
+                                                  std::memory_order_acq_rel,
+                                                  std::memory_order_acquire))
+      ;
+
+    return n;
+  }
+
+  /**
+   * Get the oldest ticket still available in the buffer given the first
+   * ticket not published
+   */
+  sequence_t oldest(sequence_t c) const {
+    sequence_t d = drop.load(std::memory_order_acquire);
+    sequence_t o = (c > S - 1) ? c - (S - 1) : 0;
+    return (d > o) ? d : o;
+  }
+};
+
+template <size_t S, size_t A>
+struct RTML_protocol_control<S, RTML_single_producer, A> {
+  typedef std::atomic<sequence_t> counter_t;
+
+  /**
+   * The number of events pushed, i.e. the next sequence to be written. Only
+   * the writer stores it (pop excepted).
+   */
+  alignas(RTML_alignment<counter_t, A>::value) counter_t top;
+
+  /**
+   * Every event below drop has been consumed with RTML_buffer::pull
+   */
+  alignas(RTML_alignment<counter_t, A>::value) counter_t drop;
+
+  RTML_protocol_control() {
+    top.store(0);
+    drop.store(0);
+  }
+
+  /**
+   * Get the oldest event still available in the buffer given the top
+   */
+  sequence_t oldest(sequence_t t) const {
+    sequence_t d = drop.load(std::memory_order_acquire);
+    sequence_t o = (t > S - 1) ? t - (S - 1) : 0;
+    return (d > o) ? d : o;
+  }
+};
+
+/**
+ * Sequence numbers of the S slots of a RTML_buffer for the gap detection G
+ * and the writer protocol W, aligned to A bytes. Only RTML_sequence_gap keeps
+ * them; the ticket protocol has them in its control block.
+ */
+template <size_t S, typename G, typename W, size_t A = 1>
+struct RTML_slot_sequence {
+  void store(size_t, sequence_t) {}
+
+  sequence_t load(size_t) const { return 0; }
+};
+
+template <size_t S, size_t A>
+struct RTML_slot_sequence<S, RTML_sequence_gap, RTML_ticket, A> {
+  void store(size_t, sequence_t) {}
+
+  sequence_t load(size_t) const { return 0; }
+};
+
+template <size_t S, typename W, size_t A>
+struct RTML_slot_sequence<S, RTML_sequence_gap, W, A> {
+  typedef std::atomic<sequence_t> counter_t;
+
+  alignas(RTML_alignment<counter_t, A>::value) counter_t seq[S];
+
+  RTML_slot_sequence() {
+    for (size_t i = 0; i < S; i++)
+      seq[i].store(0);
+  }
+
+  void store(size_t index, sequence_t s) {
+    seq[index].store(s, std::memory_order_release);
+  }
+
+  sequence_t load(size_t index) const {
+    return seq[index].load(std::memory_order_acquire);
+  }
+};
+
+/**
+ * States of page swap writers kept by a RTML_buffer with the address mode M.
+ * With absolute addresses each writer keeps its own.
+ */
+template <typename S, typename M> struct RTML_state_table {
+  S *attach() { return NULL; }
+};
+
+template <typename S, unsigned W>
+struct RTML_state_table<S, RTML_relative_address<W>> {
+  /**
+   * The two states of each writer
+   */
+  S state[W][2];
+
+  /**
+   * The number of writers that have taken their states
+   */
+  std::atomic<unsigned> attached;
+
+  RTML_state_table() : state(), attached(0) {}
+
+  /**
+   * Take the states of a new writer (NULL when W writers are attached)
+   */
+  S *attach() {
+    unsigned id = attached.fetch_add(1, std::memory_order_relaxed);
+    return (id < W) ? state[id] : NULL;
+  }
+};
+
+/**
+ * Claims of the S slots of a RTML_buffer by the page swap pushes that write
+ * them for the completion C, aligned to A bytes. Only RTML_help_completion
+ * keeps them, since a helper may copy an event into its slot after the page
+ * has moved on.
+ */
+template <size_t S, typename C, size_t A = 1> struct RTML_slot_claim {};
+
+template <size_t S, size_t A>
+struct RTML_slot_claim<S, RTML_help_completion, A> {
+  typedef NATIVE_POINTER_TYPE tag_t;
+  typedef std::atomic<tag_t> claim_t;
+
+  /**
+   * The low bits of a claim count the writers copying into the slot
+   */
+  static const unsigned shift = 8;
+  static const tag_t writers = ((tag_t)1 << shift) - 1;
+
+  /**
+   * The page counter of the push that wrote each slot last (high bits) and
+   * the number of writers still copying its event (low bits)
+   */
+  alignas(RTML_alignment<claim_t, A>::value) claim_t claim[S];
+
+  RTML_slot_claim() {
+    for (size_t i = 0; i < S; i++)
+      claim[i].store(0);
+  }
+
+  /**
+   * Claim the slot for the push published with the page counter k. Writers
+   * of the same push copy the same event, so they may share the claim. It
+   * returns 1 once the slot is claimed, 0 when the slot has been written for
+   * this push or a later one, and -1 while an older push still writes it.
+   */
+  int acquire(size_t index, tag_t k) {
+    const tag_t mine = k << shift;
+    tag_t t = claim[index].load(std::memory_order_acquire);
+    tag_t n;
+
+    do {
+      // the page counters are compared modulo their width
+      typename std::make_signed<tag_t>::type d =
+          (typename std::make_signed<tag_t>::type)((t & ~writers) - mine);
+
+      if (d > 0 || (d == 0 && (t & writers) == 0))
+        return 0;
+      if (d < 0 && (t & writers) != 0)
+        return -1;
+
+      n = (d == 0) ? t + 1 : mine + 1;
+    } while (!claim[index].compare_exchange_weak(
+        t, n, std::memory_order_acq_rel, std::memory_order_acquire));
+
+    return 1;
+  }
+
+  /**
+   * Release the claim once the event is copied
+   */
+  void release(size_t index) {
+    claim[index].fetch_sub(1, std::memory_order_release);
+  }
+};
+
+template <size_t S, size_t A>
+struct RTML_slot_version<S, RTML_versioned_slot, A> {
+  typedef std::atomic<size_t> version_t;
+
+  alignas(RTML_alignment<version_t, A>::value) version_t version[S];
+
+  RTML_slot_version() {
+    for (size_t i = 0; i < S; i++)
+      version[i].store(0);
+  }
+
+  /**
+   * Make the version odd before the slot is written
+   */
+  void begin_write(size_t index) {
+    version[index].fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /**
+   * Make the version even once the slot is written
+   */
+  void end_write(size_t index) {
+    version[index].fetch_add(1, std::memory_order_release);
+  }
+
+  /**
+   * Get the version before copying the slot (odd while it is written)
+   */
+  size_t begin_read(size_t index) const {
+    return version[index].load(std::memory_order_acquire);
+  }
+
+  /**
+   * Check that the slot has not been written since begin_read
+   */
+  bool validate(size_t index, size_t v) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version[index].load(std::memory_order_relaxed) == v;
+  }
+};
+
+/**
+ * A record of the spill ring: the sequence number of the event (zero while
+ * the record is written) and the event
+ */
+template <typename T> struct RTML_spill_record {
+  std::atomic<sequence_t> seq;
+  T event;
+};
+
+/**
+ * The spill ring of a RTML_buffer of events T for the spill S. Without a
+ * spill no event is kept.
+ */
+template <typename T, typename S> struct RTML_spill_ring {
+  void put(sequence_t, const T &) {}
+
+  bool get(sequence_t, T &) const { return false; }
+};
+
+template <typename T> struct RTML_spill_ring<T, RTML_file_spill> {
+  typedef RTML_spill_record<T> record_t;
+
+  /**
+   * The records mapped by RTML_spill_file (NULL until it is attached)
+   */
+  record_t *records;
+
+  size_t capacity;
+
+  RTML_spill_ring() : records(NULL), capacity(0) {}
+
+  /**
+   * Keep the event with the sequence number s, replacing the one capacity
+   * events older
+   */
+  void put(sequence_t s, const T &event) {
+    if (records == NULL)
+      return;
+
+    record_t &r = records[s % capacity];
+    r.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    r.event = event;
+    r.seq.store(s, std::memory_order_release);
+  }
+
+  /**
+   * Get the event with the sequence number s if the ring still keeps it
+   */
+  bool get(sequence_t s, T &event) const {
+    if (records == NULL || s == 0)
+      return false;
+
+    const record_t &r = records[s % capacity];
+    if (r.seq.load(std::memory_order_acquire) != s)
+      return false;
+
+    event = r.event;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return r.seq.load(std::memory_order_relaxed) == s;
+  }
+};
+
+#endif
+
+#endif //_RTML_BUFFER_POLICY_H_
@@ -22,37 +22,45 @@
 #ifndef _RTML_CIRCULARBUFFER_H_
 #define _RTML_CIRCULARBUFFER_H_
 
+#include "buffer_policy.h"
 #include "debug_compat.h"
 #include "event.h"
 
 #include <cstdint>
+#include <type_traits>
 
 /**
  * RTML_buffer implements a circular buffer. This buffer is the support
  * for RTML_reader and RTML_writer classes. For instance, The monitor uses
  * an instance of RTML_reader and SUO uses RTML_writer.
  *
+ * The policy P selects the writer protocol and the layout (see
+ * RTML_buffer_policy).
+ *
  * @see Event
  * @see RTML_reader
  * @see RTML_monitor
+ * @see RTML_buffer_policy
  *
  * @author André Pedro
  * @date
  */
-template <typename T, size_t N> class RTML_buffer {
+template <typename T, size_t N, typename P = RTML_buffer_policy>
+class RTML_buffer {
 private:
   /**
    * The T buffer where data is kept. The size is defined via template
-   * parameter N which avoids dynamic memory usage.
+   * parameter N which avoids dynamic memory usage. The storage of the policy
+   * lays the slots out (see RTML_buffer_policy).
    *
    * @see T
    */
-  T array[N + 2];
+  RTML_slot_storage<T, N + 2, typename P::storage, P::alignment> array;
 
   /**
    * The top of the circular buffer
    */
-  size_t __top;
+  alignas(RTML_alignment<size_t, P::alignment>::value) size_t __top;
 
   /**
    * The bottom of the circular buffer
@@ -70,8 +78,7 @@ private:
    */
   size_t &increment_top() {
     size_t &t = _top();
-    if (++t >= size)
-      t = 0;
+    t = index_t::next(t);
     return t;
   };
 
@@ -80,10 +87,7 @@ private:
    */
   size_t &decrement_top() {
     size_t &t = _top();
-    if (t == 0)
-      t = size - 1;
-    else
-      --t;
+    t = index_t::prev(t);
     return t;
   };
 
@@ -92,22 +96,268 @@ private:
    */
   size_t &increment_bottom() {
     size_t &b = _bottom();
-    if (++b >= size)
-      b = 0;
+    b = index_t::next(b);
     return b;
   };
 
+  /**
+   * Protocol specific implementations of push, pull, pop and state
+   */
+  typedef typename P::writer_protocol protocol_t;
+
+#ifndef __HW__
+  /**
+   * Copy the event of a slot that is about to be overwritten to the spill
+   */
+  void retire(size_t, RTML_no_spill) {}
+  void retire(size_t, RTML_file_spill);
+#endif
+
+  /**
+   * Search a sorted segment of consecutive slots (see upper_bound)
+   */
+  size_t bisect(const timespan &, size_t, size_t) const;
+
+  /**
+   * Copy an event in or out of a slot under its version
+   */
+  void store(const T &, size_t);
+  bool load(T &, size_t) const;
+
+  /**
+   * Check if the storage keeps the timestamp of the next pushed node
+   */
+  bool admits(const T &, RTML_event_storage) const { return true; }
+  bool admits(const T &, RTML_split_storage) const { return true; }
+  template <typename M> bool admits(const T &, M) const;
+
+  bool read(T *, size_t, size_t, RTML_plain_slot) const;
+  bool read(T *, size_t, size_t, RTML_versioned_slot) const;
+
+  bool push(const T &, RTML_page_swap);
+  bool pull(T &, RTML_page_swap);
+  bool pop(T &, RTML_page_swap);
+  void state(size_t &, size_t &, RTML_page_swap) const;
+
+#ifndef __HW__
+  bool push(const T &, RTML_ticket);
+  bool pull(T &, RTML_ticket);
+  bool pop(T &, RTML_ticket);
+  void state(size_t &, size_t &, RTML_ticket) const;
+
+  bool push(const T &, RTML_single_producer);
+  bool pull(T &, RTML_single_producer);
+  bool pop(T &, RTML_single_producer);
+  void state(size_t &, size_t &, RTML_single_producer) const;
+
+  sequence_t sequence(size_t, RTML_page_swap) const;
+  sequence_t sequence(size_t, RTML_ticket) const;
+  sequence_t sequence(size_t, RTML_single_producer) const;
+#endif
+
+  /**
+   * Check if the last writer attached may push with the writer protocol
+   */
+  template <typename W> bool attachable(W) const { return true; }
+  bool attachable(RTML_single_producer) const { return writer == 1; }
+
 public:
   const size_t size = N + 1;
   const size_t size_util = N;
 
   typedef T event_t;
 
-  typedef enum { OK = 0, EMPTY, BUFFER_OVERFLOW, OUT_OF_BOUND, UNSAFE } error_t;
+  typedef P policy_t;
+
+  /**
+   * The alignment of the layout (see RTML_buffer_policy)
+   */
+  static const size_t alignment = P::alignment;
+
+  typedef typename P::writer_protocol writer_protocol;
+
+  /**
+   * The index arithmetic of the ring (see RTML_buffer_policy)
+   */
+  typedef RTML_index<N + 1, typename P::index_mode> index_t;
+
+  typedef typename P::gap_detection gap_detection;
+
+  typedef typename P::slot_mode slot_mode;
+
+  typedef typename P::backoff backoff_t;
+
+  typedef typename P::completion completion_t;
+
+  static_assert(RTML_completion_slot<completion_t, slot_mode>::valid,
+                "RTML_help_completion requires RTML_plain_slot");
+
+  static_assert(RTML_slot_protocol<slot_mode, writer_protocol>::valid,
+                "RTML_ticket requires RTML_plain_slot");
+
+  typedef typename P::clock_source clock_source_t;
+
+  typedef enum {
+    OK = 0,
+    EMPTY,
+    BUFFER_OVERFLOW,
+    OUT_OF_BOUND,
+    UNSAFE,
+    TORN
+  } error_t;
 
   ATOMIC_TYPE();
   ATOMIC_PAGE();
 
+#ifndef __HW__
+  /**
+   * How the page refers to writer states (see RTML_buffer_policy)
+   */
+  typedef typename P::address_mode address_mode;
+
+  /**
+   * The states of page swap writers kept in the buffer (see
+   * RTML_relative_address)
+   */
+  RTML_state_table<state_t, address_mode> writer_states;
+
+  /**
+   * Get the writer state referred to by a page
+   */
+  state_t *resolve(page_t page) const {
+    return resolve(page, address_mode());
+  }
+
+  state_t *resolve(page_t page, RTML_absolute_address) const {
+    return (state_t *)page.stateref;
+  }
+
+  template <unsigned W>
+  state_t *resolve(page_t page, RTML_relative_address<W>) const {
+    return (state_t *)((char *)this + page.stateref);
+  }
+
+  /**
+   * Get the reference of a writer state to be kept in a page
+   */
+  NATIVE_POINTER_TYPE reference(const state_t *s) const {
+    return reference(s, address_mode());
+  }
+
+  NATIVE_POINTER_TYPE reference(const state_t *s,
+                                RTML_absolute_address) const {
+    return (NATIVE_POINTER_TYPE)s;
+  }
+
+  template <unsigned W>
+  NATIVE_POINTER_TYPE reference(const state_t *s,
+                                RTML_relative_address<W>) const {
+    return (NATIVE_POINTER_TYPE)((const char *)s - (const char *)this);
+  }
+#endif
+
+  /**
+   * The control block of the writer protocol
+   */
+  typedef RTML_protocol_control<N + 1, writer_protocol, P::alignment>
+      control_t;
+
+  alignas(RTML_alignment<control_t, P::alignment>::value) control_t control;
+
+#ifndef __HW__
+  /**
+   * The sequence numbers of the slots (see RTML_sequence_gap)
+   */
+  typedef RTML_slot_sequence<N + 1, gap_detection, writer_protocol,
+                             P::alignment>
+      slot_sequence_t;
+
+  slot_sequence_t slot_sequence;
+
+  /**
+   * Wait until the writer of the previous lap of the slot of a ticket has
+   * published it, so a lapped ticket writer never overwrites a newer event
+   */
+  void claim(sequence_t ticket) const {
+    backoff_t backoff;
+    while (!control.ready(ticket))
+      backoff.wait();
+  }
+
+  /**
+   * The claims of the slots by page swap pushes (see RTML_help_completion)
+   */
+  typedef RTML_slot_claim<N + 1, completion_t, P::alignment> slot_claim_t;
+
+  slot_claim_t slot_claim;
+
+  /**
+   * Claim the slot at the index before the page swap push published with the
+   * page counter k writes it, waiting while an older push still writes it. It
+   * returns false when the slot has been written for the push already.
+   */
+  bool seize(size_t, NATIVE_POINTER_TYPE, RTML_wait_completion) {
+    return true;
+  }
+
+  bool seize(size_t index, NATIVE_POINTER_TYPE k, RTML_help_completion) {
+    backoff_t backoff;
+    int c;
+    while ((c = slot_claim.acquire(index, k)) < 0)
+      backoff.wait();
+    return c > 0;
+  }
+
+  /**
+   * Release the slot at the index once the page swap push has written it
+   */
+  void release(size_t, RTML_wait_completion) {}
+
+  void release(size_t index, RTML_help_completion) {
+    slot_claim.release(index);
+  }
+#endif
+
+  /**
+   * The versions of the slots (see RTML_versioned_slot)
+   */
+  typedef RTML_slot_version<N + 1, slot_mode, P::alignment> slot_version_t;
+
+  slot_version_t slot_version;
+
+  typedef typename P::notification notification;
+
+  /**
+   * The channel writers notify blocked readers with (see
+   * RTML_wakeup_notification)
+   */
+  typedef RTML_notifier<notification> notifier_t;
+
+  notifier_t notifier;
+
+#ifndef __HW__
+  typedef typename P::spill spill_mode;
+
+  static_assert(RTML_spill_gap<spill_mode, gap_detection>::valid,
+                "RTML_file_spill requires RTML_sequence_gap");
+
+  /**
+   * The ring that keeps overwritten events (see RTML_file_spill)
+   */
+  RTML_spill_ring<T, spill_mode> spill;
+#endif
+
+  /**
+   * Start writing the slot at the index. The event it keeps is spilled
+   * first (see RTML_buffer_policy).
+   */
+  void begin_write(size_t index) {
+#ifndef __HW__
+    retire(index, spill_mode());
+#endif
+    slot_version.begin_write(index);
+  }
+
   /**
    * Instantiates a new RTML_buffer.
    */
@@ -129,15 +379,92 @@ public:
   error_t pop(event_t &);
 
   /**
-   * Get the node at index without changing the state
+   * Get the node at index without changing the state. It returns TORN when
+   * the node keeps changing while it is copied (see RTML_versioned_slot).
    */
   error_t read(event_t &, size_t) const;
 
+  /**
+   * Get consecutive nodes from the index without changing the state. The
+   * nodes wrap around the end of the buffer (at most two copies).
+   */
+  error_t read(event_t *, size_t, size_t) const;
+
+  /**
+   * Get the timestamp of the node at the index without copying its payload
+   * (see RTML_split_storage). It returns TORN like read.
+   */
+  error_t read_time(timespan &, size_t) const;
+
+  /**
+   * Get the number of the count nodes from the index (wrapping around the
+   * end of the buffer) whose timestamps are up to t, i.e., the offset of the
+   * first node after t. The nodes are at most two sorted segments of the
+   * array; the segment of t is bisected in O(log count) steps (see
+   * search_window of RTML_buffer_policy). Timestamps must be non-decreasing;
+   * they are compared without checking slot versions, so the result of a
+   * search that overlaps writes must be checked with read_time.
+   */
+  size_t upper_bound(const timespan &, size_t, size_t) const;
+
   /**
    * Set a node at the index without changing the state
    */
   error_t write(event_t &, size_t);
 
+  /**
+   * Set consecutive nodes from the index without changing the state. The
+   * nodes wrap around the end of the buffer (at most two copies).
+   */
+  error_t write(const event_t *, size_t, size_t);
+
+  /**
+   * Get a reference to the node at the index without changing the state
+   * (used to build events in place between slot_version.begin_write and
+   * slot_version.end_write). Only RTML_event_storage keeps whole events.
+   */
+  event_t &slot(size_t index) { return array.at(index); }
+
+  /**
+   * Copy an event into the slot at the index between
+   * slot_version.begin_write and slot_version.end_write
+   */
+  void place(const event_t &event, size_t index) { array.put(index, event); }
+
+  typedef typename P::storage storage;
+
+  static_assert(RTML_storage_protocol<storage, writer_protocol>::valid,
+                "RTML_delta_storage does not support RTML_ticket");
+
+  /**
+   * Check if the storage keeps the timestamps of count consecutive events
+   * written from the index; the nodes before the index must be written (see
+   * RTML_delta_storage)
+   */
+  bool fits(const event_t *events, size_t count, size_t index) const {
+    size_t first = (index + count > size) ? size - index : count;
+
+    return array.fits(index, events, first) &&
+           array.fits(0, events + first, count - first);
+  }
+
+#ifndef __HW__
+  /**
+   * Get the sequence number of the event at the index, i.e. the number of
+   * events pushed before it plus one (zero if the slot has not been written).
+   * It is only kept with RTML_sequence_gap or RTML_ticket.
+   */
+  sequence_t sequence(size_t index) const {
+    return sequence(index, protocol_t());
+  }
+
+  /**
+   * Set the sequence number of the event at the index once the event is
+   * written (nothing is kept with RTML_timestamp_gap)
+   */
+  void mark(size_t index, sequence_t seq) { slot_sequence.store(index, seq); }
+#endif
+
   /**
    * Get the state of the buffer without timestamps
    */
@@ -159,28 +486,56 @@ public:
   void debug() const;
 
   /**
-   * Copy
+   * Copy the bytes of the buffer. Buffers with a notifier (a mutex and a
+   * condition variable off Linux) or a spill (a mapping of the process) can
+   * not be copied, so they can not be assigned.
    */
   RTML_buffer &operator=(const RTML_buffer &);
 
   /**
-   * Increment writer counter
+   * Increment writer counter. It returns false when the writer protocol
+   * admits a single writer and another one is already attached.
    */
-  void increment_writer() {
+  bool increment_writer() {
     writer++;
+    return attachable(protocol_t());
   }
 };
 
-template <typename T, size_t N>
-RTML_buffer<T, N>::RTML_buffer() : __top(0), __bottom(0), writer(0) {}
+template <typename T, size_t N, typename P>
+RTML_buffer<T, N, P>::RTML_buffer() : __top(0), __bottom(0), writer(0) {}
+
+template <typename T, size_t N, typename P>
+typename RTML_buffer<T, N, P>::error_t
+RTML_buffer<T, N, P>::push(const event_t &node) {
+
+  if (!admits(node, storage()))
+    return OUT_OF_BOUND;
+
+  bool p = push(node, protocol_t());
+
+  return (p) ? BUFFER_OVERFLOW : (writer > 1 ? UNSAFE : OK);
+}
+
+template <typename T, size_t N, typename P>
+template <typename M>
+bool RTML_buffer<T, N, P>::admits(const event_t &node, M) const {
+  size_t b, t;
+  state(b, t, protocol_t());
+
+  return fits(&node, 1, t);
+}
 
-template <typename T, size_t N>
-typename RTML_buffer<T, N>::error_t
-RTML_buffer<T, N>::push(const event_t &node) {
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::push(const event_t &node, RTML_page_swap) {
 
   size_t &t = _top();
   size_t &b = _bottom();
-  array[t] = node;
+  store(node, t);
+
+#ifndef __HW__
+  mark(t, ++_count());
+#endif
 
   increment_top();
 
@@ -194,86 +549,379 @@ RTML_buffer<T, N>::push(const event_t &node) {
 
   DEBUGV3("push-> %d (%d,%d) r:%d\n", length(), b, t, p);
 
-  return (p) ? BUFFER_OVERFLOW : (writer > 1 ? UNSAFE : OK);
+  return p;
+}
+
+template <typename T, size_t N, typename P>
+typename RTML_buffer<T, N, P>::error_t
+RTML_buffer<T, N, P>::pull(event_t &event) {
+  bool c = pull(event, protocol_t());
+
+  DEBUGV3("pull-> %d r:%d e:%d\n", length(), c, event.getTime());
+
+  return c ? (writer > 1 ? UNSAFE : OK) : EMPTY;
 }
 
-template <typename T, size_t N>
-typename RTML_buffer<T, N>::error_t RTML_buffer<T, N>::pull(event_t &event) {
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::pull(event_t &event, RTML_page_swap) {
   bool c = length() > 0;
   if (c) {
-    event = array[_bottom()];
+    array.get(event, _bottom());
     increment_bottom();
   }
 
-  DEBUGV3("pull-> %d (%d,%d) r:%d e:%d\n", length(), _bottom(), _top(), c,
-          event.getTime());
+  return c;
+}
+
+template <typename T, size_t N, typename P>
+typename RTML_buffer<T, N, P>::error_t
+RTML_buffer<T, N, P>::pop(event_t &event) {
+  bool c = pop(event, protocol_t());
+
+  DEBUGV3("pop-> %d r:%d e:%d\n", length(), c, event.getTime());
 
   return c ? (writer > 1 ? UNSAFE : OK) : EMPTY;
 }
 
-template <typename T, size_t N>
-typename RTML_buffer<T, N>::error_t RTML_buffer<T, N>::pop(event_t &event) {
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::pop(event_t &event, RTML_page_swap) {
   bool c = length() > 0;
   if (c) {
     size_t &t = decrement_top();
-    event = array[t];
+    array.get(event, t);
+
+#ifndef __HW__
+    // the next push takes the sequence number of the popped event
+    --_count();
+#endif
   }
 
-  DEBUGV3("pop-> %d (%d,%d) r:%d e:%d\n", length(), _bottom(), _top(), c,
-          event.getTime());
+  return c;
+}
+
+#ifndef __HW__
 
-  return c ? (writer > 1 ? UNSAFE : OK) : EMPTY;
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::push(const event_t &node, RTML_ticket) {
+
+  sequence_t ticket = control.reserve.fetch_add(1, std::memory_order_acq_rel);
+
+  claim(ticket);
+  store(node, index_t::slot(ticket));
+
+  control.publish(ticket);
+
+  // the push discards one element when the buffer was already full
+  return ticket >= control.drop.load(std::memory_order_acquire) + size_util;
 }
 
-template <typename T, size_t N>
-typename RTML_buffer<T, N>::error_t
-RTML_buffer<T, N>::read(event_t &event, size_t index) const {
-  if (index < size)
-    event = array[index];
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::pull(event_t &event, RTML_ticket) {
+  sequence_t c = control.committed();
+  sequence_t o = control.oldest(c);
 
-  return index < size ? OK : OUT_OF_BOUND;
+  bool r = o < c;
+  if (r) {
+    array.get(event, index_t::slot(o));
+    control.drop.store(o + 1, std::memory_order_release);
+  }
+
+  return r;
+}
+
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::pop(event_t &event, RTML_ticket) {
+  sequence_t c = control.committed();
+  sequence_t o = control.oldest(c);
+
+  // only a buffer without pushes in progress can be popped
+  bool r = o < c && control.reserve.compare_exchange_strong(
+                        c, c - 1, std::memory_order_acq_rel);
+  if (r) {
+    array.get(event, index_t::slot(c - 1));
+    // keep the oldest ticket; a pop never brings back discarded events
+    control.drop.store(o, std::memory_order_release);
+    control.seq[(c - 1) % size].store(c - 1, std::memory_order_release);
+    control.commit.store(c - 1, std::memory_order_release);
+  }
+
+  return r;
+}
+
+template <typename T, size_t N, typename P>
+void RTML_buffer<T, N, P>::state(size_t &b, size_t &t, RTML_ticket) const {
+  sequence_t c = control.committed();
+
+  b = index_t::slot(control.oldest(c));
+  t = index_t::slot(c);
+}
+
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::push(const event_t &node, RTML_single_producer) {
+
+  sequence_t t = control.top.load(std::memory_order_relaxed);
+
+  store(node, index_t::slot(t));
+  mark(index_t::slot(t), t + 1);
+
+  control.top.store(t + 1, std::memory_order_release);
+
+  return t >= control.drop.load(std::memory_order_acquire) + size_util;
+}
+
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::pull(event_t &event, RTML_single_producer) {
+  sequence_t t = control.top.load(std::memory_order_acquire);
+  sequence_t o = control.oldest(t);
+
+  bool r = o < t;
+  if (r) {
+    array.get(event, index_t::slot(o));
+    control.drop.store(o + 1, std::memory_order_release);
+  }
+
+  return r;
 }
 
-template <typename T, size_t N>
-typename RTML_buffer<T, N>::error_t RTML_buffer<T, N>::write(event_t &event,
-                                                             size_t index) {
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::pop(event_t &event, RTML_single_producer) {
+  sequence_t t = control.top.load(std::memory_order_acquire);
+  sequence_t o = control.oldest(t);
+
+  // the top belongs to the writer; pop must not race with its pushes
+  bool r = o < t;
+  if (r) {
+    array.get(event, index_t::slot(t - 1));
+    control.top.store(t - 1, std::memory_order_release);
+    control.drop.store(o, std::memory_order_release);
+  }
+
+  return r;
+}
+
+template <typename T, size_t N, typename P>
+void RTML_buffer<T, N, P>::state(size_t &b, size_t &t,
+                                 RTML_single_producer) const {
+  sequence_t top = control.top.load(std::memory_order_acquire);
+
+  b = index_t::slot(control.oldest(top));
+  t = index_t::slot(top);
+}
+
+template <typename T, size_t N, typename P>
+sequence_t RTML_buffer<T, N, P>::sequence(size_t index,
+                                          RTML_single_producer) const {
+  return slot_sequence.load(index);
+}
+
+template <typename T, size_t N, typename P>
+sequence_t RTML_buffer<T, N, P>::sequence(size_t index, RTML_page_swap) const {
+  return slot_sequence.load(index);
+}
+
+template <typename T, size_t N, typename P>
+sequence_t RTML_buffer<T, N, P>::sequence(size_t index, RTML_ticket) const {
+  // the slot keeps the last published ticket plus one
+  return control.seq[index].load(std::memory_order_acquire);
+}
+
+template <typename T, size_t N, typename P>
+void RTML_buffer<T, N, P>::retire(size_t index, RTML_file_spill) {
+  sequence_t s = sequence(index);
+  event_t event;
+
+  // the event must not change while it is copied
+  if (s > 0 && read(event, index) == OK && sequence(index) == s)
+    spill.put(s, event);
+}
+
+#endif
+
+template <typename T, size_t N, typename P>
+void RTML_buffer<T, N, P>::store(const event_t &event, size_t index) {
+  begin_write(index);
+  array.put(index, event);
+  slot_version.end_write(index);
+}
+
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::load(event_t &event, size_t index) const {
+  for (unsigned i = 0; i < P::read_retries; i++) {
+    size_t v = slot_version.begin_read(index);
+
+    // the slot is being written
+    if (v & 1)
+      continue;
+
+    array.get(event, index);
+
+    if (slot_version.validate(index, v))
+      return true;
+  }
+
+  return false;
+}
+
+template <typename T, size_t N, typename P>
+typename RTML_buffer<T, N, P>::error_t
+RTML_buffer<T, N, P>::read(event_t &event, size_t index) const {
+  if (index >= size)
+    return OUT_OF_BOUND;
+
+  return load(event, index) ? OK : TORN;
+}
+
+template <typename T, size_t N, typename P>
+typename RTML_buffer<T, N, P>::error_t
+RTML_buffer<T, N, P>::read_time(timespan &time, size_t index) const {
+  if (index >= size)
+    return OUT_OF_BOUND;
+
+  for (unsigned i = 0; i < P::read_retries; i++) {
+    size_t v = slot_version.begin_read(index);
+
+    if (v & 1)
+      continue;
+
+    time = array.time(index);
+
+    if (slot_version.validate(index, v))
+      return OK;
+  }
+
+  return TORN;
+}
+
+template <typename T, size_t N, typename P>
+size_t RTML_buffer<T, N, P>::upper_bound(const timespan &t, size_t index,
+                                         size_t count) const {
+  size_t first = (index + count > size) ? size - index : count;
+
+  // the second segment starts at the first slot of the array
+  if (first < count && array.time(0) <= t)
+    return first + bisect(t, 0, count - first);
+
+  return bisect(t, index, first);
+}
+
+template <typename T, size_t N, typename P>
+size_t RTML_buffer<T, N, P>::bisect(const timespan &t, size_t index,
+                                    size_t count) const {
+  // the first node after t is in [lo, hi]
+  size_t lo = 0, hi = count;
+
+  while (hi - lo > P::search_window) {
+    size_t mid = lo + (hi - lo) / 2;
+
+    if (array.time(index + mid) <= t)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo + array.upper_bound(index + lo, hi - lo, t);
+}
+
+template <typename T, size_t N, typename P>
+typename RTML_buffer<T, N, P>::error_t
+RTML_buffer<T, N, P>::read(event_t *events, size_t count,
+                           size_t index) const {
+  if (index >= size || count > size)
+    return OUT_OF_BOUND;
+
+  return read(events, count, index, slot_mode()) ? OK : TORN;
+}
+
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::read(event_t *events, size_t count, size_t index,
+                                RTML_plain_slot) const {
+  size_t first = (index + count > size) ? size - index : count;
+
+  array.get(events, index, first);
+  array.get(events + first, 0, count - first);
+
+  return true;
+}
+
+template <typename T, size_t N, typename P>
+bool RTML_buffer<T, N, P>::read(event_t *events, size_t count, size_t index,
+                                RTML_versioned_slot) const {
+  // each slot is checked against its own version
+  for (size_t i = 0; i < count; i++)
+    if (!load(events[i], index_t::advance(index, i)))
+      return false;
+
+  return true;
+}
+
+template <typename T, size_t N, typename P>
+typename RTML_buffer<T, N, P>::error_t
+RTML_buffer<T, N, P>::write(event_t &event, size_t index) {
   if (index < size)
-    array[index] = event;
+    store(event, index);
 
   return index < size ? OK : OUT_OF_BOUND;
 }
 
-template <typename T, size_t N>
-typename RTML_buffer<T, N>::error_t RTML_buffer<T, N>::state(size_t &b,
-                                                             size_t &t) const {
-  ATOMIC_TRIPLE(b, t);
+template <typename T, size_t N, typename P>
+typename RTML_buffer<T, N, P>::error_t
+RTML_buffer<T, N, P>::write(const event_t *events, size_t count,
+                            size_t index) {
+  if (index >= size || count > size)
+    return OUT_OF_BOUND;
+
+  size_t first = (index + count > size) ? size - index : count;
+
+  for (size_t i = 0; i < count; i++)
+    begin_write(index_t::advance(index, i));
+
+  array.put(index, events, first);
+  array.put(0, events + first, count - first);
+
+  for (size_t i = 0; i < count; i++)
+    slot_version.end_write(index_t::advance(index, i));
+
+  return OK;
+}
+
+template <typename T, size_t N, typename P>
+typename RTML_buffer<T, N, P>::error_t
+RTML_buffer<T, N, P>::state(size_t &b, size_t &t) const {
+  state(b, t, protocol_t());
 
   DEBUGV3("b=0x%x t=0x%x\n", b, t);
 
   return OK;
 }
 
-template <typename T, size_t N>
-typename RTML_buffer<T, N>::error_t
-RTML_buffer<T, N>::state(size_t &b, size_t &t, timespanw &ts,
-                         timespanw &ts_t) const {
+template <typename T, size_t N, typename P>
+void RTML_buffer<T, N, P>::state(size_t &b, size_t &t, RTML_page_swap) const {
+  ATOMIC_TRIPLE(b, t);
+}
+
+template <typename T, size_t N, typename P>
+typename RTML_buffer<T, N, P>::error_t
+RTML_buffer<T, N, P>::state(size_t &b, size_t &t, timespanw &ts,
+                            timespanw &ts_t) const {
   state(b, t);
 
-  ts = array[b].getTime();
-  ts_t = array[t].getTime();
+  ts = array.time(b);
+  ts_t = array.time(t);
 
   DEBUGV3("timestamp=[0x%x,0x%x] b=0x%x t=0x%x\n", L(ts >> 32), L(ts), b, t);
 
   return OK;
 }
 
-template <typename T, size_t N> size_t RTML_buffer<T, N>::length() const {
+template <typename T, size_t N, typename P>
+size_t RTML_buffer<T, N, P>::length() const {
   size_t b, t;
   state(b, t);
-  return (t >= b) ? t - b : size - (b - t);
+  return index_t::distance(b, t);
 }
 
-template <typename T, size_t N> void RTML_buffer<T, N>::debug() const {
+template <typename T, size_t N, typename P>
+void RTML_buffer<T, N, P>::debug() const {
   size_t b, t;
   timespanw ts, ts_t;
   state(b, t, ts, ts_t);
@@ -287,15 +935,24 @@ template <typename T, size_t N> void RTML_buffer<T, N>::debug() const {
   for (unsigned int idx = 0; idx < size + 2; idx++) {
     if (idx % 2 == 0)
       DEBUGV3_APPEND("\n");
-    array[idx].debug();
+    event_t e;
+    array.get(e, idx);
+    e.debug();
   }
 
   DEBUGV3_APPEND("\n");
   DEBUGV3("__________\n");
 }
 
-template <typename T, size_t N>
-RTML_buffer<T, N> &RTML_buffer<T, N>::operator=(const RTML_buffer<T, N> &rhs) {
+template <typename T, size_t N, typename P>
+RTML_buffer<T, N, P> &
+RTML_buffer<T, N, P>::operator=(const RTML_buffer<T, N, P> &rhs) {
+#ifndef __HW__
+  static_assert(std::is_same<notification, RTML_no_notification>::value &&
+                    std::is_same<spill_mode, RTML_no_spill>::value,
+                "buffers with notifications or spills can not be assigned");
+#endif
+
   MEMCPY(this, &rhs, sizeof(rhs));
   return *this;
 }
@@ -0,0 +1,149 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CLOCK_COMPAT_H_
+#define _CLOCK_COMPAT_H_
+
+// Architecture dependent clock sources for event timestamps
+
+#include "time_compat.h"
+
+#include <stdint.h>
+
+/**
+ * Clock source of the architecture (see clockgettime in time_compat.h), i.e.,
+ * CLOCK_REALTIME on x86 and x86_64.
+ */
+struct RTML_realtime_clock {
+  static timespan now() { return clockgettime(); }
+};
+
+/**
+ * Clock source that counts the ticks of a user supplied counter (e.g., a
+ * hardware timer or the tick count of the kernel) of `Ns` nanoseconds each.
+ *
+ * \code
+ * struct tick_policy : RTML_buffer_policy {
+ *   typedef RTML_tick_clock<TickType_t, xTaskGetTickCount, 1000000>
+ *       clock_source;
+ * };
+ * \endcode
+ */
+template <typename T, T (*Tick)(), timespan Ns = 1> struct RTML_tick_clock {
+  static timespan now() { return (timespan)Tick() * Ns; }
+};
+
+#if !defined(__HW__) && defined(__linux__)
+
+/**
+ * Clock source read from CLOCK_MONOTONIC_COARSE, which the vDSO answers
+ * without reading the hardware counter. Its resolution is the kernel tick
+ * (1 to 4ms, see clock_getres), so events pushed in between share their
+ * timestamp.
+ */
+struct RTML_coarse_clock {
+  static timespan now() {
+    struct timespec n;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &n);
+    return (timespan)n.tv_sec * 1000000000 + n.tv_nsec;
+  }
+};
+
+#endif
+
+#if !defined(__HW__) && (defined(__x86__) || defined(__x86_64__))
+
+#include <x86intrin.h>
+
+/**
+ * Clock source read from the time stamp counter of the processor and scaled
+ * to nanoseconds of CLOCK_MONOTONIC. The scale is calibrated against
+ * CLOCK_MONOTONIC over `Us` microseconds by calibrate(), which must be
+ * called once before the writers run, e.g., in the setup of the
+ * application; until then the clock reads CLOCK_MONOTONIC. The counter must
+ * be invariant (constant_tsc and nonstop_tsc in /proc/cpuinfo) and
+ * synchronized between cores, as on recent x86_64 processors.
+ *
+ * \code
+ * RTML_tsc_clock<>::calibrate();
+ * \endcode
+ */
+template <unsigned Us = 10000> struct RTML_tsc_clock {
+  /**
+   * The nanoseconds of a tick in 32.32 fixed point and the origin of both
+   * clocks
+   */
+  struct calibration {
+    uint64_t scale;
+    uint64_t tsc;
+    timespan ns;
+  };
+
+  /**
+   * The calibration; its scale is zero until calibrate is called
+   */
+  static calibration calibrated;
+
+  static timespan monotonic() {
+    struct timespec n;
+    clock_gettime(CLOCK_MONOTONIC, &n);
+    return (timespan)n.tv_sec * 1000000000 + n.tv_nsec;
+  }
+
+  /**
+   * Measure the scale of the counter; it sleeps for `Us` microseconds
+   */
+  static void calibrate() {
+    struct timespec period = {Us / 1000000, (long)(Us % 1000000) * 1000};
+
+    timespan ns = monotonic();
+    uint64_t tsc = __rdtsc();
+
+    nanosleep(&period, NULL);
+
+    calibration c;
+    c.ns = monotonic();
+    c.tsc = __rdtsc();
+    c.scale = ((uint64_t)(c.ns - ns) << 32) / (c.tsc - tsc);
+
+    calibrated = c;
+  }
+
+  static timespan now() {
+    const calibration &c = calibrated;
+
+    if (c.scale == 0)
+      return monotonic();
+
+    uint64_t ticks = __rdtsc() - c.tsc;
+
+    // split product that does not overflow for counters of 1GHz or more
+    return c.ns + (timespan)((ticks >> 32) * c.scale +
+                             (((ticks & 0xffffffff) * c.scale) >> 32));
+  }
+};
+
+template <unsigned Us>
+typename RTML_tsc_clock<Us>::calibration RTML_tsc_clock<Us>::calibrated;
+
+#endif
+
+#endif //_CLOCK_COMPAT_H_
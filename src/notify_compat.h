@@ -0,0 +1,155 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _NOTIFY_COMPAT_H_
+#define _NOTIFY_COMPAT_H_
+
+// Architecture dependent notification channels between writers and readers
+
+#include "atomic_compat.h"
+
+/**
+ * Notification where writers never wake readers; readers poll the buffer.
+ */
+struct RTML_no_notification {};
+
+/**
+ * Notification where a writer wakes the readers blocked on the buffer once
+ * its pushes cross the watermark of the buffer policy or it pushes an urgent
+ * event. The channel is a futex on Linux and a condition variable elsewhere;
+ * a notification costs an atomic increment unless a reader is blocked.
+ */
+struct RTML_wakeup_notification {};
+
+/**
+ * Channel of a RTML_buffer for the notification M. Without notifications
+ * readers are never woken and a wait returns at once.
+ */
+template <typename M> struct RTML_notifier {
+  void notify() {}
+
+  bool wait(uint32_t &, const struct timespec *) const { return false; }
+
+  static bool wait_until(void *, uint32_t *, const struct timespec *) {
+    return false;
+  }
+};
+
+#if !defined(__HW__) && !defined(NO_THREADS)
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <time.h>
+
+template <> struct RTML_notifier<RTML_wakeup_notification> {
+  /**
+   * The number of notifications (the futex word on Linux)
+   */
+  mutable std::atomic<uint32_t> seq;
+
+  /**
+   * The number of readers blocked in wait
+   */
+  mutable std::atomic<uint32_t> waiters;
+
+#if !defined(__linux__)
+  mutable pthread_mutex_t mutex;
+  mutable pthread_cond_t cond;
+#endif
+
+  RTML_notifier() : seq(0), waiters(0) {
+#if !defined(__linux__)
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+#endif
+  }
+
+  /**
+   * Wake every blocked reader. The system is only called when a reader is
+   * blocked; both counters are sequentially consistent so that a reader that
+   * blocks after the increment sees it.
+   */
+  void notify() {
+    seq.fetch_add(1);
+
+    if (waiters.load() == 0)
+      return;
+
+#if defined(__linux__)
+    syscall(SYS_futex, &seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&mutex);
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+#endif
+  }
+
+  /**
+   * Block until a notification arrives after the one seen last or until the
+   * absolute time (CLOCK_REALTIME) expires. It returns true and updates seen
+   * when there is a notification not seen yet.
+   */
+  bool wait(uint32_t &seen, const struct timespec *abs) const {
+    uint32_t s = seq.load();
+
+    if (s == seen) {
+      waiters.fetch_add(1);
+
+#if defined(__linux__)
+      syscall(SYS_futex, &seq, FUTEX_WAIT_BITSET | FUTEX_CLOCK_REALTIME, s,
+              abs, NULL, FUTEX_BITSET_MATCH_ANY);
+#else
+      pthread_mutex_lock(&mutex);
+      while (seq.load() == s &&
+             pthread_cond_timedwait(&cond, &mutex, abs) == 0)
+        ;
+      pthread_mutex_unlock(&mutex);
+#endif
+
+      waiters.fetch_sub(1);
+      s = seq.load();
+    }
+
+    bool notified = s != seen;
+    seen = s;
+
+    return notified;
+  }
+
+  /**
+   * Type erased wait for tasks (see RTML_monitor::wakeup)
+   */
+  static bool wait_until(void *notifier, uint32_t *seen,
+                         const struct timespec *abs) {
+    return ((RTML_notifier *)notifier)->wait(*seen, abs);
+  }
+};
+
+#endif
+
+#endif //_NOTIFY_COMPAT_H_
@@ -122,6 +122,16 @@ public:
   void setPeriod(const useconds_t &p);
 
   int join();
+
+  /**
+   * Runs the monitor as soon as a writer notifies the buffer (see
+   * RTML_wakeup_notification) instead of at the next period only. The period
+   * still bounds the time between two runs. It must be called before the
+   * monitor is enabled.
+   *
+   * @param buffer the buffer that wakes the monitor.
+   */
+  template <typename B> void wakeup(B &buffer);
 };
 
 template <char... name>
@@ -178,4 +188,11 @@ template <char... name> int RTML_monitor<name...>::join() {
   return 0;
 }
 
+template <char... name>
+template <typename B>
+void RTML_monitor<name...>::wakeup(B &buffer) {
+  _task.notification = &buffer.notifier;
+  _task.wait_notification = &B::notifier_t::wait_until;
+}
+
 #endif // RTML_PERIODICMONITOR_H
@@ -25,6 +25,8 @@
 #include "circularbuffer.h"
 #include "event.h"
 
+#include <type_traits>
+
 /**
  * Reader to support local RTML_buffer management.
  *
@@ -53,14 +55,29 @@ protected:
    */
   timespanw timestamp;
 
+#ifndef __HW__
+  /**
+   * The sequence number of the next event to read (see RTML_sequence_gap)
+   */
+  sequence_t sequence = 0;
+
+  /**
+   * The last notification seen by the reader (see RTML_wakeup_notification)
+   */
+  uint32_t notified = 0;
+
+  /**
+   * The sequence number up to which the events of a gap are read from the
+   * spill of the buffer (see RTML_file_spill)
+   */
+  sequence_t recover = 0;
+#endif
+
   /**
    * Decrement top of the reader
    */
   size_t &decrement_reader_top() {
-    if (top == 0)
-      top = buffer.size - 1;
-    else
-      --top;
+    top = B::index_t::prev(top);
     return top;
   };
 
@@ -68,8 +85,7 @@ protected:
    * Increment bottom of the reader
    */
   size_t &increment_reader_bottom() {
-    if (++bottom >= buffer.size)
-      bottom = 0;
+    bottom = B::index_t::next(bottom);
     return bottom;
   };
 
@@ -77,10 +93,7 @@ protected:
    * Decrement bottom of the reader
    */
   size_t &decrement_reader_bottom() {
-    if (bottom == 0)
-      bottom = buffer.size - 1;
-    else
-      --bottom;
+    bottom = B::index_t::prev(bottom);
     return bottom;
   };
 
@@ -113,6 +126,28 @@ public:
    */
   error_t pull(typename B::event_t &);
 
+  /**
+   * Pull up to max events from the buffer in FIFO order. Events are copied
+   * as one or two contiguous spans and the gap is checked once per batch.
+   *
+   * @param events a pointer to the storage for at least max events.
+   * @param max the maximum number of events to pull.
+   * @param n the number of events pulled.
+   *
+   * @return an errot_t
+   *
+   */
+  error_t pull_n(typename B::event_t *, size_t, size_t &);
+
+  /**
+   * Discard up to n events from the bottom without reading them, as pull
+   * would. With RTML_timestamp_gap the last event is kept for the timestamp
+   * of the reader.
+   *
+   * @return the number of events discarded.
+   */
+  size_t skip(size_t);
+
   /**
    * Pop event from the buffer.
    *
@@ -143,10 +178,63 @@ public:
    */
   size_t length() const;
 
+#ifndef __HW__
+  /**
+   * Get the number of events overwritten before being read. It is exact with
+   * RTML_sequence_gap and it is cleared by synchronize.
+   *
+   * @return the number of lost events.
+   */
+  sequence_t lost() const;
+
+  /**
+   * Blocks until a writer notifies the buffer or the absolute time
+   * (CLOCK_REALTIME) expires. A notification that arrived since the last
+   * wait returns at once; without RTML_wakeup_notification it never blocks.
+   *
+   * @return true if the reader has been notified, false otherwise.
+   */
+  bool wait(const struct timespec *abs) {
+    return buffer.notifier.wait(notified, abs);
+  }
+#endif
+
   /**
    * Debug function
    */
   void debug() const;
+
+private:
+  /**
+   * Gap detection specific implementations (see RTML_buffer_policy)
+   */
+  typedef typename B::gap_detection detection_t;
+
+  error_t pull(typename B::event_t &, RTML_timestamp_gap);
+  error_t pull_n(typename B::event_t *, size_t, size_t &, RTML_timestamp_gap);
+  size_t skip(size_t, RTML_timestamp_gap);
+  gap_error_t synchronize(RTML_timestamp_gap);
+  gap_error_t gap(RTML_timestamp_gap) const;
+
+#ifndef __HW__
+  error_t pull(typename B::event_t &, RTML_sequence_gap);
+  error_t pull_n(typename B::event_t *, size_t, size_t &, RTML_sequence_gap);
+  size_t skip(size_t, RTML_sequence_gap);
+  gap_error_t synchronize(RTML_sequence_gap);
+  gap_error_t gap(RTML_sequence_gap) const;
+
+  /**
+   * The sequence number of the oldest event kept by the buffer
+   */
+  sequence_t oldest() const;
+
+  /**
+   * Read the next event of a gap from the spill of the buffer. The last one
+   * may still be in the slot before the bottom, which is discarded but not
+   * overwritten yet.
+   */
+  bool recall(typename B::event_t &) const;
+#endif
 };
 
 template <typename B>
@@ -156,6 +244,12 @@ RTML_reader<B>::RTML_reader(const B &_buffer)
 template <typename B>
 typename RTML_reader<B>::error_t
 RTML_reader<B>::pull(typename B::event_t &event) {
+  return pull(event, detection_t());
+}
+
+template <typename B>
+typename RTML_reader<B>::error_t
+RTML_reader<B>::pull(typename B::event_t &event, RTML_timestamp_gap) {
 
   typename B::event_t event_next;
   const int delta = 1;
@@ -188,6 +282,78 @@ RTML_reader<B>::pull(typename B::event_t &event) {
   return UNAVAILABLE;
 }
 
+template <typename B>
+typename RTML_reader<B>::error_t
+RTML_reader<B>::pull_n(typename B::event_t *events, size_t max, size_t &n) {
+  return pull_n(events, max, n, detection_t());
+}
+
+template <typename B>
+typename RTML_reader<B>::error_t
+RTML_reader<B>::pull_n(typename B::event_t *events, size_t max, size_t &n,
+                       RTML_timestamp_gap) {
+
+  typename B::event_t event_next;
+  const int delta = 1;
+
+  n = 0;
+
+  if (length() > delta && max > 0) {
+    n = (length() - delta < max) ? length() - delta : max;
+
+    if (buffer.read(events, n, bottom) != buffer.OK) {
+      n = 0;
+      return READ_ERROR;
+    }
+
+    // update local bottom
+    bottom = B::index_t::advance(bottom, n);
+
+    DEBUGV3("pull_n-> n=%lu length=%lu bottom=%lu top=%lu\n", n, length(),
+            bottom, top);
+
+    // use last known timestamp (one gap check for the whole batch)
+    if (buffer.read(event_next, bottom) == buffer.OK) {
+      timestamp = event_next.getTime();
+
+      if (gap())
+        return READER_OVERFLOW;
+      else
+        return AVAILABLE;
+    } else {
+      bottom = B::index_t::retreat(bottom, n);
+      n = 0;
+      return READ_ERROR;
+    }
+  }
+
+  return UNAVAILABLE;
+}
+
+template <typename B> size_t RTML_reader<B>::skip(size_t n) {
+  return skip(n, detection_t());
+}
+
+template <typename B>
+size_t RTML_reader<B>::skip(size_t n, RTML_timestamp_gap) {
+  timespan t;
+  const size_t delta = 1;
+
+  if (length() <= delta)
+    return 0;
+
+  n = (length() - delta < n) ? length() - delta : n;
+
+  // the timestamp of the new bottom, as pull
+  if (buffer.read_time(t, B::index_t::advance(bottom, n)) != buffer.OK)
+    return 0;
+
+  bottom = B::index_t::advance(bottom, n);
+  timestamp = t;
+
+  return n;
+}
+
 template <typename B>
 typename RTML_reader<B>::error_t
 RTML_reader<B>::pop(typename B::event_t &event) {
@@ -210,6 +376,12 @@ RTML_reader<B>::pop(typename B::event_t &event) {
 
 template <typename B>
 typename RTML_reader<B>::gap_error_t RTML_reader<B>::synchronize() {
+  return synchronize(detection_t());
+}
+
+template <typename B>
+typename RTML_reader<B>::gap_error_t
+RTML_reader<B>::synchronize(RTML_timestamp_gap) {
   /*
    * The synchronization depends on the buffer state. Any event that is
    * overwritten without being read is identified as a gap for the reader.
@@ -275,6 +447,12 @@ typename RTML_reader<B>::gap_error_t RTML_reader<B>::synchronize() {
 
 template <typename B>
 typename RTML_reader<B>::gap_error_t RTML_reader<B>::gap() const {
+  return gap(detection_t());
+}
+
+template <typename B>
+typename RTML_reader<B>::gap_error_t
+RTML_reader<B>::gap(RTML_timestamp_gap) const {
   typename B::event_t event;
 
   // detect a gap
@@ -290,8 +468,212 @@ typename RTML_reader<B>::gap_error_t RTML_reader<B>::gap() const {
   return NO_GAP;
 }
 
+#ifndef __HW__
+
+template <typename B>
+typename RTML_reader<B>::error_t
+RTML_reader<B>::pull(typename B::event_t &event, RTML_sequence_gap) {
+
+  // the gap found by synchronize is read from the spill first
+  if (sequence < recover) {
+    if (recall(event)) {
+      ++sequence;
+      return AVAILABLE;
+    }
+
+    // the spill has overwritten the rest of the gap
+    sequence = recover;
+    return READER_OVERFLOW;
+  }
+
+  if (length() > 0) {
+    sequence_t s = buffer.sequence(bottom);
+
+    // the event is still being written
+    if (s < sequence)
+      return UNAVAILABLE;
+
+    if (s == sequence) {
+      if (buffer.read(event, bottom) != buffer.OK)
+        return READ_ERROR;
+
+      // the event must not be overwritten while it is copied
+      std::atomic_thread_fence(std::memory_order_acquire);
+      s = buffer.sequence(bottom);
+    }
+
+    // an overwritten event may be kept by the spill
+    if (s > sequence && !buffer.spill.get(sequence, event))
+      return READER_OVERFLOW;
+
+    increment_reader_bottom();
+    ++sequence;
+
+    DEBUGV3("pull-> length=%lu bottom=%lu top=%lu\n", length(), bottom, top);
+
+    return AVAILABLE;
+  }
+
+  return UNAVAILABLE;
+}
+
+template <typename B>
+typename RTML_reader<B>::error_t
+RTML_reader<B>::pull_n(typename B::event_t *events, size_t max, size_t &n,
+                       RTML_sequence_gap) {
+
+  n = 0;
+
+  // the gap found by synchronize is read from the spill first
+  if (sequence < recover && max > 0) {
+    while (n < max && sequence < recover && recall(events[n])) {
+      ++n;
+      ++sequence;
+    }
+
+    if (n > 0)
+      return AVAILABLE;
+
+    sequence = recover;
+    return READER_OVERFLOW;
+  }
+
+  if (length() > 0 && max > 0) {
+    size_t m = (length() < max) ? length() : max;
+
+    // take the events that are completely written
+    while (n < m &&
+           buffer.sequence(B::index_t::advance(bottom, n)) == sequence + n)
+      ++n;
+
+    if (n == 0) {
+      if (buffer.sequence(bottom) <= sequence)
+        return UNAVAILABLE;
+
+      // an overwritten event may be kept by the spill
+      if (!buffer.spill.get(sequence, events[0]))
+        return READER_OVERFLOW;
+
+      n = 1;
+      increment_reader_bottom();
+      ++sequence;
+      return AVAILABLE;
+    }
+
+    if (buffer.read(events, n, bottom) != buffer.OK) {
+      n = 0;
+      return READ_ERROR;
+    }
+
+    // writers overwrite the oldest slot of the batch first
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (buffer.sequence(bottom) != sequence) {
+      n = 0;
+      return READER_OVERFLOW;
+    }
+
+    bottom = B::index_t::advance(bottom, n);
+    sequence += n;
+
+    DEBUGV3("pull_n-> n=%lu length=%lu bottom=%lu top=%lu\n", n, length(),
+            bottom, top);
+
+    return AVAILABLE;
+  }
+
+  return UNAVAILABLE;
+}
+
+template <typename B>
+size_t RTML_reader<B>::skip(size_t n, RTML_sequence_gap) {
+  n = (length() < n) ? length() : n;
+
+  // the events of a gap read from the spill precede the bottom
+  if (sequence < recover)
+    sequence = recover;
+
+  bottom = B::index_t::advance(bottom, n);
+  sequence += n;
+
+  return n;
+}
+
+template <typename B>
+typename RTML_reader<B>::gap_error_t
+RTML_reader<B>::synchronize(RTML_sequence_gap) {
+  /*
+   * The reader is synchronized for the first time or after a gap, i.e. when
+   * the event at its bottom is newer than the one it expects.
+   */
+  size_t b, t;
+  buffer.state(b, t);
+
+  if (sequence == 0 || gap() == GAP) {
+    sequence_t o = oldest();
+    typename B::event_t event;
+
+    top = t;
+    bottom = b;
+
+    // the events of the gap are read from the spill while it keeps them
+    recover = o;
+    if (sequence != 0 && recall(event))
+      return NO_GAP;
+
+    sequence = o;
+
+    return GAP;
+  }
+
+  top = t;
+  return NO_GAP;
+}
+
+template <typename B>
+typename RTML_reader<B>::gap_error_t
+RTML_reader<B>::gap(RTML_sequence_gap) const {
+  // while a gap is read from the spill, the bottom expects its end
+  sequence_t expected = (recover > sequence) ? recover : sequence;
+
+  return (buffer.sequence(bottom) > expected) ? GAP : NO_GAP;
+}
+
+template <typename B> sequence_t RTML_reader<B>::oldest() const {
+  size_t b, t;
+  buffer.state(b, t);
+
+  // an empty buffer expects the event after the last one pushed
+  return (b != t) ? buffer.sequence(b)
+                  : buffer.sequence(B::index_t::prev(t)) + 1;
+}
+
+template <typename B>
+bool RTML_reader<B>::recall(typename B::event_t &event) const {
+  if (buffer.spill.get(sequence, event))
+    return true;
+
+  size_t index = B::index_t::prev(bottom);
+  if (buffer.sequence(index) != sequence ||
+      buffer.read(event, index) != buffer.OK)
+    return false;
+
+  // the event must not be overwritten while it is copied
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return buffer.sequence(index) == sequence;
+}
+
+template <typename B> sequence_t RTML_reader<B>::lost() const {
+  static_assert(std::is_same<detection_t, RTML_sequence_gap>::value,
+                "lost requires the RTML_sequence_gap gap detection");
+
+  sequence_t o = oldest();
+  return (o > sequence) ? o - sequence : 0;
+}
+
+#endif
+
 template <typename B> size_t RTML_reader<B>::length() const {
-  return (top >= bottom) ? top - bottom : (buffer.size) - (bottom - top);
+  return B::index_t::distance(bottom, top);
 }
 
 template <typename B> void RTML_reader<B>::debug() const {
@@ -25,6 +25,7 @@
 
 #include <utility>
 
+#include "horizon.h"
 #include "rmtld3.h"
 #include "terms.h"
 
@@ -37,18 +38,17 @@ template <typename T>
 three_valued_type prop(T &trace, const proposition &p, timespan &t) {
 
   typename T::buffer_t::event_t e;
-  typename T::buffer_t::event_t e_next;
-
-  typename T::error_t status = trace.read(e);
-
-  if (status == trace.AVAILABLE && trace.read_next(e_next) == trace.AVAILABLE &&
-      e.getTime() <= t && t < e_next.getTime()) {
-    DEBUGV_RMTLD3("eval: t=%lu prop=%d e=(%d %d) e_next=(%d %d)\n", t, p,
-                  e.getData(), e.getTime(), e_next.getData(), e_next.getTime());
+  timespan time, time_next;
+
+  // the payload is only read once the timestamps hold t
+  if (trace.read_time(time) == trace.AVAILABLE &&
+      trace.read_next_time(time_next) == trace.AVAILABLE && time <= t &&
+      t < time_next && trace.read(e) == trace.AVAILABLE) {
+    DEBUGV_RMTLD3("eval: t=%lu prop=%d e=(%d %d) next=%d\n", t, p,
+                  e.getData(), e.getTime(), time_next);
     return e.getData() == p ? T_TRUE : T_FALSE;
   } else {
-    DEBUGV_RMTLD3("eval: t=%lu prop=%d e=(%d %d) unbounded\n", t, p,
-                  e.getData(), e.getTime());
+    DEBUGV_RMTLD3("eval: t=%lu prop=%d unbounded\n", t, p);
     return T_UNKNOWN;
   }
 }
@@ -102,13 +102,10 @@ three_valued_type until_less(T &trace, timespan &t) {
 
     four_valued_type symbol = FV_SYMBOL;
 
-    typename T::buffer_t::event_t event;
-
     do {
       DEBUGV_RMTLD3("t=%d c_time=%d len=%d\n", t, c_time, trace.length());
 
-      trace.read(event);
-      c_time = event.getTime();
+      trace.read_time(c_time);
 
       if (c_time >= b + t) /* Check: > or >= */
         break;
@@ -122,16 +119,13 @@ three_valued_type until_less(T &trace, timespan &t) {
       if (v == false) {
         size_t store_cursor = trace.get_cursor();
         timespan t1, t2, t3 = c_time;
-        typename T::buffer_t::event_t e1, e2;
         while (true) {
           trace.increment_cursor();
-          if (trace.length() <= 1 || trace.read(e1) != trace.AVAILABLE ||
-              trace.read_next(e2) != trace.AVAILABLE) {
+          if (trace.length() <= 1 || trace.read_time(t1) != trace.AVAILABLE ||
+              trace.read_next_time(t2) != trace.AVAILABLE) {
             break;
           }
 
-          t1 = e1.getTime();
-          t2 = e2.getTime();
           t3 += (t2 - t1);
 
           if (t3 >= t1)
@@ -153,7 +147,7 @@ three_valued_type until_less(T &trace, timespan &t) {
       if (symbol != FV_SYMBOL)
         break;
 
-    } while (trace.pull(event) == trace.AVAILABLE);
+    } while (trace.advance() == trace.AVAILABLE);
 
     return std::make_pair(symbol, c_time);
   };
@@ -183,7 +177,6 @@ template <typename T, typename E, timespan b>
 three_valued_type eventually_equal(T &trace, timespan &t) {
 
   timespan c_time = t;
-  typename T::buffer_t::event_t event;
   three_valued_type symbol = T_UNKNOWN;
 
   size_t c_eventually = trace.get_cursor();
@@ -191,8 +184,7 @@ three_valued_type eventually_equal(T &trace, timespan &t) {
   do {
     DEBUGV_RMTLD3("t=%d c_time=%d len=%d\n", t, c_time, trace.length());
 
-    trace.read(event);
-    c_time = event.getTime();
+    trace.read_time(c_time);
 
     if (c_time > b + t)
       break;
@@ -205,7 +197,7 @@ three_valued_type eventually_equal(T &trace, timespan &t) {
         c); // reset the cursor changes during the evaluation of the subformula
 
     trace.debug();
-  } while (trace.pull(event) == trace.AVAILABLE);
+  } while (trace.advance() == trace.AVAILABLE);
 
   trace.set_cursor(c_eventually); // reset the cursor changes during the
                                   // evaluation of the subformula
@@ -221,7 +213,6 @@ template <typename T, typename E>
 three_valued_type eventually_less_unbounded(T &trace, timespan &t) {
 
   timespan c_time = t;
-  typename T::buffer_t::event_t event;
   three_valued_type symbol = T_FALSE;
 
   size_t c_eventually = trace.get_cursor();
@@ -229,8 +220,7 @@ three_valued_type eventually_less_unbounded(T &trace, timespan &t) {
   while (true) {
     DEBUGV_RMTLD3("t=%d c_time=%lu len=%d\n", t, c_time, trace.length());
 
-    trace.read(event);
-    c_time = event.getTime();
+    trace.read_time(c_time);
 
     size_t c = trace.get_cursor();
     DEBUGV_RMTLD3("$compute phi\n");
@@ -245,7 +235,7 @@ three_valued_type eventually_less_unbounded(T &trace, timespan &t) {
     if (symbol != T_FALSE)
       break;
 
-    if (trace.pull(event) != trace.AVAILABLE)
+    if (trace.advance() != trace.AVAILABLE)
       break;
   };
 
@@ -345,13 +335,12 @@ three_valued_type since_less(T &trace, timespan &t) {
 
     four_valued_type symbol = FV_SYMBOL;
 
-    typename T::buffer_t::event_t event;
+    timespan previous;
 
     do {
       DEBUGV_RMTLD3("t=%d c_time=%lu len=%d\n", t, c_time, trace.length());
 
-      trace.read(event);
-      c_time = event.getTime();
+      trace.read_time(c_time);
 
       if (c_time == t) /* since semantics is strict and non-matching */
         continue;
@@ -368,7 +357,7 @@ three_valued_type since_less(T &trace, timespan &t) {
         break;
 
     } while (trace.decrement_cursor() == trace.AVAILABLE &&
-             trace.read(event) == trace.AVAILABLE);
+             trace.read_time(previous) == trace.AVAILABLE);
 
     return std::make_pair(symbol, c_time);
   };
@@ -398,7 +387,7 @@ template <typename T, typename E, timespan b>
 three_valued_type pasteventually_equal(T &trace, timespan &t) {
 
   timespan c_time = t;
-  typename T::buffer_t::event_t event;
+  timespan previous;
   three_valued_type symbol = T_UNKNOWN;
 
   size_t c_pasteventually = trace.get_cursor();
@@ -406,8 +395,7 @@ three_valued_type pasteventually_equal(T &trace, timespan &t) {
   do {
     DEBUGV_RMTLD3("t=%d c_time=%lu len=%d\n", t, c_time, trace.length());
 
-    trace.read(event);
-    c_time = event.getTime();
+    trace.read_time(c_time);
 
     if (c_time == t) /* since semantics is strict and non-matching */
       continue;
@@ -424,7 +412,7 @@ three_valued_type pasteventually_equal(T &trace, timespan &t) {
 
     trace.debug();
   } while (trace.decrement_cursor() == trace.AVAILABLE &&
-           trace.read(event) == trace.AVAILABLE);
+           trace.read_time(previous) == trace.AVAILABLE);
 
   trace.set_cursor(c_pasteventually); // reset the cursor changes during the
                                       // evaluation of the subformula
@@ -472,4 +460,124 @@ three_valued_type historically_less(T &trace, timespan &t) {
                               // of the subformula
 
   return b3_not(sf);
-}
\ No newline at end of file
+}
+
+/**
+ * The evaluation of the formula a horizon type stands for. A formula
+ * evaluated from its horizon type can not disagree with its horizon, so
+ * RMTLD3_reader::retain never releases an event that it reads:
+ *
+ * \code
+ * // (1 S[4] 2) U[6] 3
+ * typedef until_less_h<since_less_h<atom_h<1>, atom_h<2>, 4>, atom_h<3>, 6> f;
+ *
+ * three_valued_type v = RMTLD3_formula<f>::eval(trace, t);
+ * trace.retain<f>(t);
+ * \endcode
+ *
+ * prop_h, op_h and the terms have no evaluation: formulas evaluated with
+ * their own Eval classes, as the generated monitors, are mirrored by hand.
+ */
+template <typename F> struct RMTLD3_formula;
+
+/**
+ * The Eval class of the subformulas F1 and F2
+ */
+template <typename T, typename F1, typename F2 = F1> struct rmtld3_eval {
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    return RMTLD3_formula<F1>::eval(trace, t);
+  }
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    return RMTLD3_formula<F2>::eval(trace, t);
+  }
+};
+
+template <proposition p> struct RMTLD3_formula<atom_h<p>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    return prop<T>(trace, p, t);
+  }
+};
+
+template <typename F> struct RMTLD3_formula<not_h<F>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    three_valued_type v = RMTLD3_formula<F>::eval(trace, t);
+    return b3_not(v);
+  }
+};
+
+template <typename F1, typename F2> struct RMTLD3_formula<or_h<F1, F2>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    three_valued_type v1 = RMTLD3_formula<F1>::eval(trace, t);
+    three_valued_type v2 = RMTLD3_formula<F2>::eval(trace, t);
+    return b3_or(v1, v2);
+  }
+};
+
+template <typename F1, typename F2> struct RMTLD3_formula<and_h<F1, F2>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    three_valued_type v1 = RMTLD3_formula<F1>::eval(trace, t);
+    three_valued_type v2 = RMTLD3_formula<F2>::eval(trace, t);
+    return b3_and(v1, v2);
+  }
+};
+
+template <typename F1, typename F2, timespan b>
+struct RMTLD3_formula<until_less_h<F1, F2, b>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    return until_less<T, rmtld3_eval<T, F1, F2>, b>(trace, t);
+  }
+};
+
+template <typename F1, typename F2, timespan b>
+struct RMTLD3_formula<since_less_h<F1, F2, b>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    return since_less<T, rmtld3_eval<T, F1, F2>, b>(trace, t);
+  }
+};
+
+template <typename F, timespan b>
+struct RMTLD3_formula<eventually_equal_h<F, b>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    return eventually_equal<T, rmtld3_eval<T, F>, b>(trace, t);
+  }
+};
+
+template <typename F, timespan b> struct RMTLD3_formula<always_equal_h<F, b>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    return always_equal<T, rmtld3_eval<T, F>, b>(trace, t);
+  }
+};
+
+template <typename F, timespan b> struct RMTLD3_formula<always_less_h<F, b>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    return always_less<T, rmtld3_eval<T, F>, b>(trace, t);
+  }
+};
+
+template <typename F>
+struct RMTLD3_formula<eventually_less_unbounded_h<F>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    return eventually_less_unbounded<T, rmtld3_eval<T, F>>(trace, t);
+  }
+};
+
+template <typename F, timespan b>
+struct RMTLD3_formula<pasteventually_equal_h<F, b>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    return pasteventually_equal<T, rmtld3_eval<T, F>, b>(trace, t);
+  }
+};
+
+template <typename F, timespan b>
+struct RMTLD3_formula<historically_equal_h<F, b>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    return historically_equal<T, rmtld3_eval<T, F>, b>(trace, t);
+  }
+};
+
+template <typename F, timespan b>
+struct RMTLD3_formula<historically_less_h<F, b>> {
+  template <typename T> static three_valued_type eval(T &trace, timespan &t) {
+    return historically_less<T, rmtld3_eval<T, F>, b>(trace, t);
+  }
+};
\ No newline at end of file
@@ -0,0 +1,207 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RMTLD3_HORIZON_H_
+#define _RMTLD3_HORIZON_H_
+
+#include <limits>
+
+#include "rmtld3.h"
+
+/**
+ * The horizon of a formula is how far after (future) and before (past) the
+ * time of its evaluation it reads the trace. Formulas are functions over
+ * Eval classes, so their horizons are computed over a type that mirrors
+ * them, with one template per operator of formulas.h and terms.h:
+ *
+ * \code
+ * // until_less<T, Eval<until_less<T, Eval_ab, 9>, c>, 10>
+ * typedef until_less_h<until_less_h<prop_h, prop_h, 9>, prop_h, 10> f;
+ *
+ * static_assert(RMTLD3_horizon<f>::future == 19, "");
+ * static_assert(RMTLD3_horizon<f>::events(1) <= 100,
+ *               "a buffer of 100 events is too short for the formula");
+ * \endcode
+ *
+ * Formulas written with these types are evaluated by RMTLD3_formula (see
+ * formulas.h), so that the horizon is derived from the formula that is
+ * evaluated.
+ *
+ * A formula without a bound (eventually_less_unbounded) has the horizon
+ * RMTLD3_HORIZON_UNBOUNDED.
+ */
+static constexpr timespan RMTLD3_HORIZON_UNBOUNDED =
+    std::numeric_limits<timespan>::max();
+
+/**
+ * Propositions and constants
+ */
+struct prop_h {};
+
+/**
+ * Boolean connectives (b3_not, b3_or, ...) and comparisons of terms of the
+ * subformulas
+ */
+template <typename... F> struct op_h {};
+
+template <typename F1, typename F2, timespan b> struct until_less_h {};
+template <typename F1, typename F2, timespan b> struct since_less_h {};
+
+template <typename F, timespan b> struct eventually_equal_h {};
+template <typename F, timespan b> struct always_equal_h {};
+template <typename F, timespan b> struct always_less_h {};
+template <typename F> struct eventually_less_unbounded_h {};
+
+template <typename F, timespan b> struct pasteventually_equal_h {};
+template <typename F, timespan b> struct historically_equal_h {};
+template <typename F, timespan b> struct historically_less_h {};
+
+template <typename F, timespan b> struct duration_term_h {};
+
+/**
+ * The proposition p and the connectives of formulas evaluated with
+ * RMTLD3_formula; their horizons are the ones of prop_h and op_h
+ */
+template <proposition p> struct atom_h {};
+template <typename F> struct not_h {};
+template <typename F1, typename F2> struct or_h {};
+template <typename F1, typename F2> struct and_h {};
+
+constexpr timespan rmtld3_horizon_max(timespan a, timespan b) {
+  return (a < b) ? b : a;
+}
+
+/**
+ * Add the horizons, up to RMTLD3_HORIZON_UNBOUNDED
+ */
+constexpr timespan rmtld3_horizon_add(timespan a, timespan b) {
+  return (a > RMTLD3_HORIZON_UNBOUNDED - b) ? RMTLD3_HORIZON_UNBOUNDED
+                                            : a + b;
+}
+
+/**
+ * A horizon from the future and past ones
+ */
+template <timespan F, timespan P> struct rmtld3_horizon {
+  static constexpr timespan future = F;
+  static constexpr timespan past = P;
+
+  /**
+   * The number of events of the horizon when they are at least
+   * min_inter_arrival time units apart, including the events before and
+   * after it that hold its ends, and the events that arrive in the period
+   * between two evaluations of the formula. Events without a minimum
+   * inter-arrival time (zero) have no bound either.
+   */
+  static constexpr size_t events(timespan min_inter_arrival,
+                                 timespan period = 0) {
+    return (min_inter_arrival == 0 ||
+            rmtld3_horizon_add(rmtld3_horizon_add(future, past), period) ==
+                RMTLD3_HORIZON_UNBOUNDED)
+               ? std::numeric_limits<size_t>::max()
+               : (future + past + period) / min_inter_arrival + 3;
+  }
+};
+
+template <timespan F, timespan P>
+constexpr timespan rmtld3_horizon<F, P>::future;
+template <timespan F, timespan P>
+constexpr timespan rmtld3_horizon<F, P>::past;
+
+/**
+ * The horizon of the subformulas read at the times from the evaluation up
+ * to b later (P = false) or earlier (P = true)
+ */
+template <typename H, timespan b, bool P>
+struct rmtld3_horizon_shift
+    : rmtld3_horizon<P ? H::future : rmtld3_horizon_add(H::future, b),
+                     P ? rmtld3_horizon_add(H::past, b) : H::past> {};
+
+/**
+ * The horizon of a formula
+ */
+template <typename F> struct RMTLD3_horizon;
+
+template <> struct RMTLD3_horizon<prop_h> : rmtld3_horizon<0, 0> {};
+
+template <> struct RMTLD3_horizon<op_h<>> : rmtld3_horizon<0, 0> {};
+
+template <typename F, typename... G>
+struct RMTLD3_horizon<op_h<F, G...>>
+    : rmtld3_horizon<
+          rmtld3_horizon_max(RMTLD3_horizon<F>::future,
+                             RMTLD3_horizon<op_h<G...>>::future),
+          rmtld3_horizon_max(RMTLD3_horizon<F>::past,
+                             RMTLD3_horizon<op_h<G...>>::past)> {};
+
+template <typename F1, typename F2, timespan b>
+struct RMTLD3_horizon<until_less_h<F1, F2, b>>
+    : rmtld3_horizon_shift<RMTLD3_horizon<op_h<F1, F2>>, b, false> {};
+
+template <typename F1, typename F2, timespan b>
+struct RMTLD3_horizon<since_less_h<F1, F2, b>>
+    : rmtld3_horizon_shift<RMTLD3_horizon<op_h<F1, F2>>, b, true> {};
+
+template <typename F, timespan b>
+struct RMTLD3_horizon<eventually_equal_h<F, b>>
+    : rmtld3_horizon_shift<RMTLD3_horizon<F>, b, false> {};
+
+template <typename F, timespan b>
+struct RMTLD3_horizon<always_equal_h<F, b>>
+    : rmtld3_horizon_shift<RMTLD3_horizon<F>, b, false> {};
+
+template <typename F, timespan b>
+struct RMTLD3_horizon<always_less_h<F, b>>
+    : rmtld3_horizon_shift<RMTLD3_horizon<F>, b, false> {};
+
+template <typename F>
+struct RMTLD3_horizon<eventually_less_unbounded_h<F>>
+    : rmtld3_horizon<RMTLD3_HORIZON_UNBOUNDED, RMTLD3_horizon<F>::past> {};
+
+template <typename F, timespan b>
+struct RMTLD3_horizon<pasteventually_equal_h<F, b>>
+    : rmtld3_horizon_shift<RMTLD3_horizon<F>, b, true> {};
+
+template <typename F, timespan b>
+struct RMTLD3_horizon<historically_equal_h<F, b>>
+    : rmtld3_horizon_shift<RMTLD3_horizon<F>, b, true> {};
+
+template <typename F, timespan b>
+struct RMTLD3_horizon<historically_less_h<F, b>>
+    : rmtld3_horizon_shift<RMTLD3_horizon<F>, b, true> {};
+
+template <typename F, timespan b>
+struct RMTLD3_horizon<duration_term_h<F, b>>
+    : rmtld3_horizon_shift<RMTLD3_horizon<F>, b, false> {};
+
+template <proposition p>
+struct RMTLD3_horizon<atom_h<p>> : RMTLD3_horizon<prop_h> {};
+
+template <typename F>
+struct RMTLD3_horizon<not_h<F>> : RMTLD3_horizon<op_h<F>> {};
+
+template <typename F1, typename F2>
+struct RMTLD3_horizon<or_h<F1, F2>> : RMTLD3_horizon<op_h<F1, F2>> {};
+
+template <typename F1, typename F2>
+struct RMTLD3_horizon<and_h<F1, F2>> : RMTLD3_horizon<op_h<F1, F2>> {};
+
+#endif //_RMTLD3_HORIZON_H_
@@ -0,0 +1,584 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RMTLD3_MERGEREADER_H_
+#define _RMTLD3_MERGEREADER_H_
+
+#include <new>
+#include <type_traits>
+
+#include "rmtld3.h"
+#include "shardedbuffer.h"
+
+/**
+ * RMTLD3_merge_reader reads the shards of a RTML_sharded_buffer as one trace,
+ * the k-way merge of the shards by timestamp (events with the same timestamp
+ * are ordered by shard). It has the interface of RMTLD3_reader, so the
+ * formulas (see formulas.h) and the generated monitors evaluate a sharded
+ * trace unchanged. The cursor is the number of merged events before it;
+ * moving it by one event compares the events of the K shards around it, and
+ * set finds the position of a time by bisecting each shard.
+ *
+ * @see RTML_sharded_buffer
+ * @see RMTLD3_reader
+ */
+template <typename S, typename P = size_t> class RMTLD3_merge_reader {
+public:
+  typedef S buffer_t;
+
+  typedef enum {
+    AVAILABLE = 0,
+    UNAVAILABLE,
+    READER_OVERFLOW,
+    READ_ERROR
+  } error_t;
+
+  typedef enum { NO_GAP = 0, GAP, UNKNOWN_GAP } gap_error_t;
+
+private:
+  typedef typename S::shard_t shard_t;
+
+  /**
+   * A RTML_reader of a shard exposing its window to the merge
+   */
+  struct shard_reader : RTML_reader<shard_t> {
+    using RTML_reader<shard_t>::buffer;
+    using RTML_reader<shard_t>::bottom;
+
+    shard_reader(const shard_t &_buffer) : RTML_reader<shard_t>(_buffer) {}
+  };
+
+  /**
+   * The readers of the shards, constructed in place since they refer to
+   * their shards
+   */
+  typename std::aligned_storage<sizeof(shard_reader),
+                                alignof(shard_reader)>::type readers[S::shards];
+
+  /**
+   * The number of events of each shard before the cursor
+   */
+  size_t position[S::shards];
+
+  /**
+   * Cursor between bottom and top of the merged shards
+   */
+  size_t cursor;
+
+  shard_reader &reader(size_t i) {
+    return *reinterpret_cast<shard_reader *>(&readers[i]);
+  }
+
+  const shard_reader &reader(size_t i) const {
+    return *reinterpret_cast<const shard_reader *>(&readers[i]);
+  }
+
+  /**
+   * Read the timestamp of the event of a shard at an offset from its bottom
+   */
+  bool time(size_t, size_t, timespan &) const;
+
+  /**
+   * Find the shard of the first event after the cursor, or of the second one
+   * when skip is the shard of the first event
+   */
+  bool first(size_t &, timespan &, size_t skip = S::shards) const;
+
+  /**
+   * Find the shard of the last event before the cursor
+   */
+  bool last(size_t &, timespan &) const;
+
+  /**
+   * Sets cursor at time t walking one event at a time (see RMTLD3_reader)
+   */
+  error_t walk(timespan &);
+
+  RMTLD3_merge_reader &operator=(const RMTLD3_merge_reader &) = delete;
+
+public:
+  /**
+   *  Local memory for dynamic programming pattern
+   */
+  P &lmem;
+
+  /**
+   * Constructor
+   */
+  RMTLD3_merge_reader(const S &_buffer);
+  RMTLD3_merge_reader(const S &_buffer, P &_lmem);
+  RMTLD3_merge_reader(const RMTLD3_merge_reader &);
+
+  ~RMTLD3_merge_reader();
+
+  /**
+   * Synchronizes the readers of all shards and resets the cursor. It returns
+   * the worst gap found in a shard (see RTML_reader::synchronize).
+   */
+  gap_error_t synchronize();
+
+  /**
+   * Resets cursor in the reader
+   */
+  error_t reset();
+
+  /**
+   * Sets cursor at time t
+   */
+  error_t set(timespan &);
+
+  /**
+   * Sets cursor, moving it one event at a time
+   */
+  error_t set_cursor(size_t &);
+
+  /**
+   * Gets cursor
+   */
+  size_t &get_cursor();
+
+  /**
+   * Increment current cursor
+   */
+  error_t increment_cursor();
+
+  /**
+   * Decrement current cursor
+   */
+  error_t decrement_cursor();
+
+  /**
+   * Pull event
+   */
+  error_t pull(typename S::event_t &);
+
+  /**
+   * Advance the cursor like pull without copying the event
+   */
+  error_t advance();
+
+  /**
+   * Read event without removing it from the buffer
+   */
+  error_t read(typename S::event_t &);
+
+  /**
+   * Read next event without removing it from the buffer
+   */
+  error_t read_next(typename S::event_t &);
+
+  /**
+   * Read previous event without removing it from the buffer
+   */
+  error_t read_previous(typename S::event_t &);
+
+  /**
+   * Read the timestamp of the event, the next event or the previous event
+   * without copying their payloads
+   */
+  error_t read_time(timespan &);
+  error_t read_next_time(timespan &);
+  error_t read_previous_time(timespan &);
+
+  /**
+   * Current buffer length of the reader
+   */
+  size_t length() const;
+
+  /**
+   * Number of reader's consumed elements from the buffer
+   */
+  size_t consumed() const { return cursor; }
+
+  /**
+   * Enable debug message for reader
+   */
+  void debug() const;
+};
+
+template <typename S, typename P>
+RMTLD3_merge_reader<S, P>::RMTLD3_merge_reader(const S &_buffer)
+    : cursor(0), lmem(cursor) {
+  for (size_t i = 0; i < S::shards; i++) {
+    new (&readers[i]) shard_reader(_buffer.shard(i));
+    position[i] = 0;
+  }
+}
+
+template <typename S, typename P>
+RMTLD3_merge_reader<S, P>::RMTLD3_merge_reader(const S &_buffer, P &_lmem)
+    : cursor(0), lmem(_lmem) {
+  for (size_t i = 0; i < S::shards; i++) {
+    new (&readers[i]) shard_reader(_buffer.shard(i));
+    position[i] = 0;
+  }
+}
+
+template <typename S, typename P>
+RMTLD3_merge_reader<S, P>::RMTLD3_merge_reader(const RMTLD3_merge_reader &o)
+    : cursor(o.cursor), lmem(o.lmem) {
+  for (size_t i = 0; i < S::shards; i++) {
+    new (&readers[i]) shard_reader(o.reader(i));
+    position[i] = o.position[i];
+  }
+}
+
+template <typename S, typename P>
+RMTLD3_merge_reader<S, P>::~RMTLD3_merge_reader() {
+  for (size_t i = 0; i < S::shards; i++)
+    reader(i).~shard_reader();
+}
+
+template <typename S, typename P>
+bool RMTLD3_merge_reader<S, P>::time(size_t i, size_t offset,
+                                     timespan &t) const {
+  const shard_reader &r = reader(i);
+
+  return r.buffer.read_time(
+             t, shard_t::index_t::advance(r.bottom, offset)) == r.buffer.OK;
+}
+
+template <typename S, typename P>
+bool RMTLD3_merge_reader<S, P>::first(size_t &s, timespan &t,
+                                      size_t skip) const {
+  bool found = false;
+
+  for (size_t i = 0; i < S::shards; i++) {
+    size_t offset = position[i] + (i == skip);
+    timespan ti;
+
+    if (offset >= reader(i).length())
+      continue;
+
+    if (!time(i, offset, ti))
+      return false;
+
+    // the first shard wins ties
+    if (!found || ti < t) {
+      s = i;
+      t = ti;
+      found = true;
+    }
+  }
+
+  return found;
+}
+
+template <typename S, typename P>
+bool RMTLD3_merge_reader<S, P>::last(size_t &s, timespan &t) const {
+  bool found = false;
+
+  for (size_t i = 0; i < S::shards; i++) {
+    timespan ti;
+
+    if (position[i] == 0)
+      continue;
+
+    if (!time(i, position[i] - 1, ti))
+      return false;
+
+    // the last shard wins ties
+    if (!found || ti >= t) {
+      s = i;
+      t = ti;
+      found = true;
+    }
+  }
+
+  return found;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::gap_error_t
+RMTLD3_merge_reader<S, P>::synchronize() {
+  gap_error_t gap = NO_GAP;
+
+  for (size_t i = 0; i < S::shards; i++) {
+    gap_error_t g = (gap_error_t)reader(i).synchronize();
+    gap = (g > gap) ? g : gap;
+  }
+
+  reset();
+
+  return gap;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t RMTLD3_merge_reader<S, P>::reset() {
+
+  for (size_t i = 0; i < S::shards; i++)
+    position[i] = 0;
+  cursor = 0;
+
+  return AVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::set(timespan &t) {
+
+  size_t n = cursor + length();
+
+  if (n < 2)
+    return walk(t);
+
+  // the events up to t are a prefix of the merge and of each shard
+  size_t k = 0, offset[S::shards];
+  for (size_t i = 0; i < S::shards; i++) {
+    const shard_reader &r = reader(i);
+    offset[i] = r.buffer.upper_bound(t, r.bottom, r.length());
+    k += offset[i];
+  }
+
+  if (k > 0 && k < n) {
+    size_t c = cursor, saved[S::shards];
+    timespan e, ee;
+
+    for (size_t i = 0; i < S::shards; i++) {
+      saved[i] = position[i];
+      position[i] = offset[i];
+    }
+    cursor = k;
+
+    // the search does not check slot versions; check the interval found
+    if (read_previous_time(e) != AVAILABLE || read_time(ee) != AVAILABLE ||
+        !(e <= t && t < ee)) {
+      for (size_t i = 0; i < S::shards; i++)
+        position[i] = saved[i];
+      cursor = c;
+      return walk(t);
+    }
+
+    // as the walk, stop after t when t is behind the cursor and at t
+    // otherwise
+    if (k > c)
+      decrement_cursor();
+
+    return AVAILABLE;
+  }
+
+  // t is out of the events of the reader
+  for (size_t i = 0; i < S::shards; i++)
+    position[i] = reader(i).length();
+  cursor = n;
+  decrement_cursor();
+
+  return UNAVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::walk(timespan &t) {
+
+  // only the timestamps are compared
+  timespan e, ee;
+
+  while (read_previous_time(e) == AVAILABLE && read_time(ee) == AVAILABLE) {
+    if (e <= t && t < ee)
+      return AVAILABLE;
+
+    decrement_cursor();
+  }
+
+  while (read_time(ee) == AVAILABLE && read_next_time(e) == AVAILABLE) {
+    if (ee <= t && t < e)
+      return AVAILABLE;
+
+    increment_cursor();
+  }
+
+  return UNAVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::set_cursor(size_t &c) {
+
+  if (c > cursor + length()) {
+    DEBUG_RMTLD3("cursor set %li is not available\n", c);
+    return UNAVAILABLE;
+  }
+
+  while (cursor < c)
+    if (increment_cursor() != AVAILABLE)
+      return READ_ERROR;
+
+  while (cursor > c)
+    if (decrement_cursor() != AVAILABLE)
+      return READ_ERROR;
+
+  return AVAILABLE;
+}
+
+template <typename S, typename P>
+size_t &RMTLD3_merge_reader<S, P>::get_cursor() {
+  return cursor;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::increment_cursor() {
+  size_t s;
+  timespan t;
+
+  if (!first(s, t))
+    return UNAVAILABLE;
+
+  position[s]++;
+  cursor++;
+
+  return AVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::decrement_cursor() {
+  size_t s;
+  timespan t;
+
+  if (!last(s, t))
+    return UNAVAILABLE;
+
+  position[s]--;
+  cursor--;
+
+  return AVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::pull(typename S::event_t &e) {
+
+  if (length() > 0) {
+    if (read(e) != AVAILABLE)
+      return READ_ERROR;
+
+    increment_cursor();
+  }
+
+  return (length() > 0) ? AVAILABLE : UNAVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::advance() {
+
+  if (length() > 0)
+    increment_cursor();
+
+  return (length() > 0) ? AVAILABLE : UNAVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::read(typename S::event_t &e) {
+  size_t s;
+  timespan t;
+
+  if (!first(s, t))
+    return UNAVAILABLE;
+
+  const shard_reader &r = reader(s);
+  return (r.buffer.read(e, shard_t::index_t::advance(r.bottom, position[s])) ==
+          r.buffer.OK)
+             ? AVAILABLE
+             : UNAVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::read_next(typename S::event_t &e) {
+  size_t h, s;
+  timespan th, t;
+
+  if (!first(h, th) || !first(s, t, h))
+    return UNAVAILABLE;
+
+  const shard_reader &r = reader(s);
+  size_t offset = position[s] + (s == h);
+  return (r.buffer.read(e, shard_t::index_t::advance(r.bottom, offset)) ==
+          r.buffer.OK)
+             ? AVAILABLE
+             : UNAVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::read_previous(typename S::event_t &e) {
+  size_t s;
+  timespan t;
+
+  if (!last(s, t))
+    return UNAVAILABLE;
+
+  const shard_reader &r = reader(s);
+  return (r.buffer.read(e, shard_t::index_t::advance(r.bottom,
+                                                      position[s] - 1)) ==
+          r.buffer.OK)
+             ? AVAILABLE
+             : UNAVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::read_time(timespan &t) {
+  size_t s;
+
+  return first(s, t) ? AVAILABLE : UNAVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::read_next_time(timespan &t) {
+  size_t h, s;
+  timespan th;
+
+  return (first(h, th) && first(s, t, h)) ? AVAILABLE : UNAVAILABLE;
+}
+
+template <typename S, typename P>
+typename RMTLD3_merge_reader<S, P>::error_t
+RMTLD3_merge_reader<S, P>::read_previous_time(timespan &t) {
+  size_t s;
+
+  return last(s, t) ? AVAILABLE : UNAVAILABLE;
+}
+
+template <typename S, typename P>
+size_t RMTLD3_merge_reader<S, P>::length() const {
+  size_t n = 0;
+
+  for (size_t i = 0; i < S::shards; i++)
+    n += reader(i).length() - position[i];
+
+  return n;
+}
+
+template <typename S, typename P>
+void RMTLD3_merge_reader<S, P>::debug() const {
+
+  for (size_t i = 0; i < S::shards; i++)
+    DEBUGV_RMTLD3("shard=%lu length=%lu position=%lu\n", i,
+                  reader(i).length(), position[i]);
+  DEBUGV_RMTLD3("cursor=%lu length=%lu\n", cursor, length());
+}
+
+#endif //_RMTLD3_MERGEREADER_H_
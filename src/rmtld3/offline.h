@@ -0,0 +1,305 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RMTLD3_OFFLINE_H_
+#define _RMTLD3_OFFLINE_H_
+
+#include "../reader.h"
+#include "horizon.h"
+#include "reader.h"
+#include "rmtld3.h"
+#include "trace_compat.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+
+/**
+ * A run of events with the same verdict: the formula evaluated at the
+ * timestamps of the events from the first to the last one has the value
+ */
+struct RMTLD3_verdict {
+  size_t first;
+  size_t last;
+  timespan from;
+  timespan to;
+  three_valued_type value;
+};
+
+/**
+ * Evaluates a formula (e.g., a generated _rtm_compute_* function) at the
+ * timestamp of each event of a trace file (see RTML_trace_buffer), as a
+ * periodic monitor released at that time would. The reader of the formula
+ * sees the whole trace, so the verdicts are not bounded by the size of a
+ * ring buffer.
+ *
+ * The trace is evaluated in blocks of events: the next block is read ahead
+ * and the pages of the blocks before the previous one are dropped, so the
+ * memory used does not grow with the length of the trace.
+ *
+ * \code
+ * RTML_trace_buffer<Event<proposition>> trace;
+ * trace.open("trace.rtmt");
+ * RMTLD3_offline<Event<proposition>> checker(trace);
+ * checker.check(_rtm_compute_6ea3_0<decltype(checker)::trace_t>, 0,
+ *               trace.length(), [](const RMTLD3_verdict &v) { ... });
+ * \endcode
+ */
+template <typename T> class RMTLD3_offline {
+public:
+  typedef RTML_trace_buffer<T> buffer_t;
+  typedef RMTLD3_reader<RTML_reader<buffer_t>> trace_t;
+  typedef three_valued_type (*compute_t)(trace_t &, timespan &);
+
+private:
+  const buffer_t &buffer;
+
+  /**
+   * The number of events of each block
+   */
+  size_t block;
+
+  /**
+   * Evaluate the events from first up to last (excluded), extending the run
+   * when it is open and passing the runs it ends to out
+   */
+  template <typename F>
+  size_t evaluate(trace_t &, compute_t, size_t, size_t, RMTLD3_verdict &,
+                  bool &, F &) const;
+
+  /**
+   * The first event of the chunk c of the events from first up to last; a
+   * chunk starts at a timestamp that the previous one does not have
+   */
+  size_t chunk(size_t c, size_t first, size_t last) const;
+
+public:
+  RMTLD3_offline(const buffer_t &_buffer, size_t _block = 1 << 16)
+      : buffer(_buffer), block(_block > 0 ? _block : 1) {}
+
+  /**
+   * Evaluate the formula at the timestamps of the events from first up to
+   * last (excluded) and pass each run of equal verdicts to out, in order.
+   * Events with the timestamp of the previous one share its verdict.
+   *
+   * @return the number of evaluations of the formula.
+   */
+  template <typename F>
+  size_t check(compute_t, size_t first, size_t last, F out) const;
+
+  /**
+   * Evaluate as above with the given number of threads, each one with its
+   * own reader. The threads take chunks of a block of events in trace
+   * order, so faster threads take more chunks. The verdicts are the same
+   * as the ones of a single thread: out is called with them in order, one
+   * call at a time, from the thread that completes the chunk following the
+   * ones passed.
+   *
+   * Each reader sees the whole trace, so the verdicts do not depend on the
+   * horizon. It only sets how far after a chunk the events are prefetched
+   * with it, e.g., 19 for until_less<..., 9> nested in until_less<..., 10>
+   * (see RMTLD3_horizon); RMTLD3_HORIZON_UNBOUNDED prefetches up to the end
+   * of the trace.
+   */
+  template <typename F>
+  size_t check(compute_t, size_t first, size_t last, F out, unsigned threads,
+               timespan horizon = 0) const;
+};
+
+template <typename T>
+template <typename F>
+size_t RMTLD3_offline<T>::evaluate(trace_t &trace, compute_t compute,
+                                   size_t first, size_t last,
+                                   RMTLD3_verdict &run, bool &open,
+                                   F &out) const {
+  size_t evaluations = 0;
+
+  for (size_t i = first; i < last; i++) {
+    timespan t = buffer.at(i).getTime();
+
+    if (open && t == run.to) {
+      run.last = i;
+      continue;
+    }
+
+    timespan now = t;
+    trace.set(now);
+    three_valued_type value = compute(trace, now);
+    evaluations++;
+
+    if (open && value == run.value) {
+      run.last = i;
+      run.to = t;
+      continue;
+    }
+
+    if (open)
+      out(run);
+
+    run.first = run.last = i;
+    run.from = run.to = t;
+    run.value = value;
+    open = true;
+  }
+
+  return evaluations;
+}
+
+template <typename T>
+template <typename F>
+size_t RMTLD3_offline<T>::check(compute_t compute, size_t first, size_t last,
+                                F out) const {
+  last = (last < buffer.length()) ? last : buffer.length();
+  if (first >= last)
+    return 0;
+
+  trace_t trace(buffer);
+  trace.synchronize();
+
+  buffer.prefetch(first, block);
+
+  size_t evaluations = 0;
+  RMTLD3_verdict run;
+  bool open = false;
+
+  for (size_t b = first; b < last; b += block) {
+    size_t end = (last - b < block) ? last : b + block;
+
+    buffer.prefetch(end, block);
+    if (b >= first + block)
+      buffer.release(b - block);
+
+    evaluations += evaluate(trace, compute, b, end, run, open, out);
+  }
+
+  out(run);
+
+  return evaluations;
+}
+
+template <typename T>
+size_t RMTLD3_offline<T>::chunk(size_t c, size_t first, size_t last) const {
+  if (c >= (last - first + block - 1) / block)
+    return last;
+
+  size_t i = first + c * block;
+  while (i > first && i < last &&
+         buffer.at(i).getTime() == buffer.at(i - 1).getTime())
+    i++;
+
+  return i;
+}
+
+template <typename T>
+template <typename F>
+size_t RMTLD3_offline<T>::check(compute_t compute, size_t first, size_t last,
+                                F out, unsigned threads,
+                                timespan horizon) const {
+  last = (last < buffer.length()) ? last : buffer.length();
+  if (first >= last)
+    return 0;
+
+  if (threads < 2)
+    return check(compute, first, last, out);
+
+  const size_t chunks = (last - first + block - 1) / block;
+
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> evaluations(0);
+
+  // the runs of the chunks completed ahead of the ones passed to out
+  std::mutex lock;
+  std::vector<std::vector<RMTLD3_verdict>> done(chunks);
+  std::vector<bool> ready(chunks, false);
+  size_t passed = 0;
+  RMTLD3_verdict run;
+  bool open = false;
+
+  auto worker = [&]() {
+    trace_t trace(buffer);
+    trace.synchronize();
+
+    std::vector<RMTLD3_verdict> runs;
+    auto collect = [&runs](const RMTLD3_verdict &v) { runs.push_back(v); };
+
+    for (size_t c = next++; c < chunks; c = next++) {
+      size_t from = chunk(c, first, last);
+      size_t to = chunk(c + 1, first, last);
+
+      if (from < to) {
+        // the sum saturates for an unbounded horizon
+        timespan end = rmtld3_horizon_add(buffer.at(to - 1).getTime(),
+                                          (horizon > 0) ? horizon : 0);
+        buffer.prefetch(from, to - from + buffer.upper_bound(
+                                               end, to, buffer.length() - to));
+      }
+
+      RMTLD3_verdict last_run;
+      bool last_open = false;
+      runs.clear();
+      evaluations +=
+          evaluate(trace, compute, from, to, last_run, last_open, collect);
+      if (last_open)
+        runs.push_back(last_run);
+
+      std::lock_guard<std::mutex> guard(lock);
+      done[c].swap(runs);
+      ready[c] = true;
+
+      // the runs of consecutive chunks with the same verdict are joined
+      for (; passed < chunks && ready[passed]; passed++) {
+        for (const RMTLD3_verdict &v : done[passed]) {
+          if (open && v.value == run.value) {
+            run.last = v.last;
+            run.to = v.to;
+          } else {
+            if (open)
+              out(run);
+            run = v;
+            open = true;
+          }
+        }
+        std::vector<RMTLD3_verdict>().swap(done[passed]);
+      }
+
+      if (passed > 1)
+        buffer.release(chunk(passed - 1, first, last));
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (unsigned i = 1; i < threads; i++)
+    pool.push_back(std::thread(worker));
+  worker();
+  for (std::thread &t : pool)
+    t.join();
+
+  out(run);
+
+  return evaluations;
+}
+
+#endif
+
+#endif //_RMTLD3_OFFLINE_H_
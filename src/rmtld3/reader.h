@@ -24,6 +24,7 @@
 
 #include <numeric>
 
+#include "horizon.h"
 #include "pattern.h"
 #include "rmtld3.h"
 
@@ -34,6 +35,12 @@ template <typename R, typename P = size_t> class RMTLD3_reader : public R {
    */
   size_t cursor;
 
+  /**
+   * Sets cursor at time t walking one event at a time, backward and then
+   * forward (used when the timestamps change during a search)
+   */
+  typename R::error_t walk(timespan &);
+
 public:
   /**
    *  Local memory for dynamic programming pattern
@@ -83,6 +90,18 @@ public:
    */
   typename R::error_t pull(typename R::buffer_t::event_t &);
 
+  /**
+   * Advance the cursor like pull without copying the event
+   */
+  typename R::error_t advance();
+
+  /**
+   * Pull up to max events from the cursor and advance the cursor. Events are
+   * copied as one or two contiguous spans.
+   */
+  typename R::error_t pull_n(typename R::buffer_t::event_t *, size_t,
+                             size_t &);
+
   /**
    * Read event without removing it from the buffer
    */
@@ -98,6 +117,36 @@ public:
    */
   typename R::error_t read_previous(typename R::buffer_t::event_t &);
 
+  /**
+   * Read the timestamp of the event, the next event or the previous event
+   * without copying their payloads (see RTML_buffer::read_time)
+   */
+  typename R::error_t read_time(timespan &);
+  typename R::error_t read_next_time(timespan &);
+  typename R::error_t read_previous_time(timespan &);
+
+  /**
+   * Release the events before the one that holds time t from the reader
+   * (see RTML_reader::skip). Formulas evaluated from t on do not read them,
+   * and the writers may overwrite them without a gap. A cursor before the
+   * released events moves to the new bottom.
+   *
+   * @return the number of events released.
+   */
+  size_t release(const timespan &);
+
+  /**
+   * Release the events that the formula F (see RMTLD3_horizon) no longer
+   * reads once it is evaluated at now, i.e., those before now minus its past
+   * horizon. Monitors call it after each evaluation, so their window does
+   * not grow with the uptime. A formula evaluated with RMTLD3_formula<F>
+   * reads no event that is released.
+   */
+  template <typename F> size_t retain(const timespan &now) {
+    const timespan past = RMTLD3_horizon<F>::past;
+    return (now > past) ? release(now - past) : 0;
+  }
+
   /**
    * Current buffer length of the reader
    */
@@ -125,13 +174,51 @@ typename R::error_t RMTLD3_reader<R, P>::reset() {
 template <typename R, typename P>
 typename R::error_t RMTLD3_reader<R, P>::set(timespan &t) {
 
-  typename R::buffer_t::event_t e, ee;
+  size_t n = R::length();
+
+  if (n < 2)
+    return walk(t);
 
-  while (read_previous(e) == R::AVAILABLE && read(ee) == R::AVAILABLE) {
+  // the offset of the first event after t (see RTML_upper_bound)
+  size_t k = R::buffer.upper_bound(t, R::bottom, n);
+  size_t after = R::buffer_t::index_t::advance(R::bottom, k);
 
-    DEBUGV_RMTLD3("--- %lu %lu\n", e.getTime(), ee.getTime());
+  if (k > 0 && k < n) {
+    timespan e, ee;
 
-    if (e.getTime() <= t && t < ee.getTime()) {
+    // the search does not check slot versions; check the interval found
+    if (R::buffer.read_time(e, R::buffer_t::index_t::prev(after)) !=
+            R::buffer.OK ||
+        R::buffer.read_time(ee, after) != R::buffer.OK || !(e <= t && t < ee))
+      return walk(t);
+
+    // as the walk, stop after t when t is behind the cursor and at t
+    // otherwise
+    cursor = (k <= R::buffer_t::index_t::distance(R::bottom, cursor))
+                 ? after
+                 : R::buffer_t::index_t::prev(after);
+
+    return R::AVAILABLE;
+  }
+
+  // t is out of the events of the reader
+  cursor = R::buffer_t::index_t::prev(R::top);
+
+  return R::UNAVAILABLE;
+}
+
+template <typename R, typename P>
+typename R::error_t RMTLD3_reader<R, P>::walk(timespan &t) {
+
+  // only the timestamps are compared
+  timespan e, ee;
+
+  while (read_previous_time(e) == R::AVAILABLE &&
+         read_time(ee) == R::AVAILABLE) {
+
+    DEBUGV_RMTLD3("--- %lu %lu\n", e, ee);
+
+    if (e <= t && t < ee) {
       return R::AVAILABLE;
     }
 
@@ -139,11 +226,11 @@ typename R::error_t RMTLD3_reader<R, P>::set(timespan &t) {
     DEBUGV_RMTLD3("backward cursor=%d\n", cursor);
   }
 
-  while (read(ee) == R::AVAILABLE && read_next(e) == R::AVAILABLE) {
+  while (read_time(ee) == R::AVAILABLE && read_next_time(e) == R::AVAILABLE) {
 
-    DEBUGV_RMTLD3("--- %lu %lu\n", ee.getTime(), e.getTime());
+    DEBUGV_RMTLD3("--- %lu %lu\n", ee, e);
 
-    if (ee.getTime() <= t && t < e.getTime()) {
+    if (ee <= t && t < e) {
       return R::AVAILABLE;
     }
 
@@ -180,9 +267,7 @@ typename R::error_t RMTLD3_reader<R, P>::increment_cursor() {
   if (R::top == cursor)
     return R::UNAVAILABLE;
 
-  // cursor = (size_t)(cursor + 1) % R::buffer.size;
-  if (++cursor >= R::buffer.size)
-    cursor = 0;
+  cursor = R::buffer_t::index_t::next(cursor);
 
   return R::AVAILABLE;
 }
@@ -194,11 +279,7 @@ typename R::error_t RMTLD3_reader<R, P>::decrement_cursor() {
   if (R::bottom == cursor)
     return R::UNAVAILABLE;
 
-  // cursor = (size_t)(cursor - 1) % R::buffer.size;
-  if (cursor == 0)
-    cursor = R::buffer.size - 1;
-  else
-    --cursor;
+  cursor = R::buffer_t::index_t::prev(cursor);
 
   return R::AVAILABLE;
 }
@@ -222,6 +303,36 @@ RMTLD3_reader<R, P>::pull(typename R::buffer_t::event_t &e) {
   return (length() > 0) ? R::AVAILABLE : R::UNAVAILABLE;
 }
 
+template <typename R, typename P>
+typename R::error_t RMTLD3_reader<R, P>::advance() {
+
+  if (length() > 0)
+    increment_cursor();
+
+  return (length() > 0) ? R::AVAILABLE : R::UNAVAILABLE;
+}
+
+template <typename R, typename P>
+typename R::error_t
+RMTLD3_reader<R, P>::pull_n(typename R::buffer_t::event_t *events, size_t max,
+                            size_t &n) {
+
+  n = (length() < max) ? length() : max;
+
+  if (n > 0) {
+    if (R::buffer.read(events, n, cursor) != R::buffer.OK) {
+      n = 0;
+      return R::READ_ERROR;
+    }
+
+    cursor = R::buffer_t::index_t::advance(cursor, n);
+  }
+
+  DEBUGV_RMTLD3("pull_n-> %d (%d,%d)\n", n, cursor, R::top);
+
+  return (length() > 0) ? R::AVAILABLE : R::UNAVAILABLE;
+}
+
 template <typename R, typename P>
 typename R::error_t
 RMTLD3_reader<R, P>::read(typename R::buffer_t::event_t &e) {
@@ -236,8 +347,7 @@ RMTLD3_reader<R, P>::read_next(typename R::buffer_t::event_t &e) {
 
   return ((length() > 1 &&
            cursor != R::top && // [TODO: check this: !(cursor == R::top)]
-           (R::buffer.read(e, ((cursor + 1) >= R::buffer.size) ? 0
-                                                               : cursor + 1)) ==
+           (R::buffer.read(e, R::buffer_t::index_t::next(cursor))) ==
                R::buffer.OK))
              ? R::AVAILABLE
              : R::UNAVAILABLE;
@@ -251,16 +361,62 @@ RMTLD3_reader<R, P>::read_previous(typename R::buffer_t::event_t &e) {
                 R::length());
   return ((consumed() > 0 &&
            cursor != R::bottom && // [TODO: check this: !(cursor == R::bottom)]
-           (R::buffer.read(e, ((cursor - 1) < 0) ? R::buffer.size - 1
-                                                 : cursor - 1)) ==
+           (R::buffer.read(e, R::buffer_t::index_t::prev(cursor))) ==
+               R::buffer.OK))
+             ? R::AVAILABLE
+             : R::UNAVAILABLE;
+}
+
+template <typename R, typename P>
+typename R::error_t RMTLD3_reader<R, P>::read_time(timespan &t) {
+
+  return (R::buffer.read_time(t, cursor) == R::buffer.OK) ? R::AVAILABLE
+                                                          : R::UNAVAILABLE;
+}
+
+template <typename R, typename P>
+typename R::error_t RMTLD3_reader<R, P>::read_next_time(timespan &t) {
+
+  return ((length() > 1 && cursor != R::top &&
+           (R::buffer.read_time(t, R::buffer_t::index_t::next(cursor))) ==
+               R::buffer.OK))
+             ? R::AVAILABLE
+             : R::UNAVAILABLE;
+}
+
+template <typename R, typename P>
+typename R::error_t RMTLD3_reader<R, P>::read_previous_time(timespan &t) {
+
+  return ((consumed() > 0 && cursor != R::bottom &&
+           (R::buffer.read_time(t, R::buffer_t::index_t::prev(cursor))) ==
                R::buffer.OK))
              ? R::AVAILABLE
              : R::UNAVAILABLE;
 }
 
+template <typename R, typename P>
+size_t RMTLD3_reader<R, P>::release(const timespan &t) {
+
+  size_t n = R::length();
+  if (n < 2)
+    return 0;
+
+  // the event that holds t is the last one up to t, and it is kept
+  size_t k = R::buffer.upper_bound(t, R::bottom, n);
+  if (k < 2)
+    return 0;
+
+  size_t behind = R::buffer_t::index_t::distance(R::bottom, cursor);
+  size_t released = R::skip(k - 1);
+
+  if (behind < released)
+    cursor = R::bottom;
+
+  return released;
+}
+
 template <typename R, typename P> size_t RMTLD3_reader<R, P>::length() const {
-  return (R::top >= cursor) ? R::top - cursor
-                            : R::buffer.size - (cursor - R::top);
+  return R::buffer_t::index_t::distance(cursor, R::top);
 }
 
 template <typename R, typename P> size_t RMTLD3_reader<R, P>::consumed() const {
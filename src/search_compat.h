@@ -0,0 +1,96 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SEARCH_COMPAT_H_
+#define _SEARCH_COMPAT_H_
+
+// Architecture dependent kernels to search arrays of timestamps
+
+#include "time_compat.h"
+
+#include <stddef.h>
+
+#if defined(__AVX2__) && defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__arm__)
+#include <arm_neon.h>
+#elif defined(__riscv_v_intrinsic) && __riscv_v_intrinsic >= 12000
+#include <riscv_vector.h>
+#endif
+
+/**
+ * Get the position of the first timestamp greater than t in an array of n
+ * non-decreasing timestamps, i.e., the number of timestamps up to t, one
+ * timestamp at a time.
+ */
+inline size_t RTML_upper_bound_scalar(const timespan *times, size_t n,
+                                      const timespan &t) {
+  size_t i = 0;
+  while (i < n && times[i] <= t)
+    i++;
+  return i;
+}
+
+/**
+ * Get the position of the first timestamp greater than t like
+ * RTML_upper_bound_scalar, comparing as many timestamps at a time as the
+ * vector unit holds: 4 with AVX2 (-mavx2 on x86_64), 4 with NEON (32-bit
+ * timestamps of ARM) and a whole vector register with the V extension of
+ * RISC-V. Other targets use the scalar scan.
+ */
+inline size_t RTML_upper_bound(const timespan *times, size_t n,
+                               const timespan &t) {
+  size_t i = 0;
+
+#if defined(__AVX2__) && defined(__x86_64__)
+  const __m256i key = _mm256_set1_epi64x(t);
+
+  for (; i + 4 <= n; i += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(times + i));
+    __m256i greater = _mm256_cmpgt_epi64(v, key);
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(greater));
+    if (mask)
+      return i + __builtin_ctz(mask);
+  }
+#elif defined(__ARM_NEON) && defined(__arm__)
+  const uint32x4_t key = vdupq_n_u32(t);
+
+  for (; i + 4 <= n; i += 4) {
+    uint32x4_t greater = vcgtq_u32(vld1q_u32(times + i), key);
+    uint32x2_t half = vorr_u32(vget_low_u32(greater), vget_high_u32(greater));
+    if (vget_lane_u32(vpmax_u32(half, half), 0))
+      return i + RTML_upper_bound_scalar(times + i, 4, t);
+  }
+#elif defined(__riscv_v_intrinsic) && __riscv_v_intrinsic >= 12000
+  while (i < n) {
+    size_t vl = __riscv_vsetvl_e64m8(n - i);
+    vuint64m8_t v = __riscv_vle64_v_u64m8(times + i, vl);
+    long first = __riscv_vfirst_m_b8(__riscv_vmsgtu_vx_u64m8_b8(v, t, vl), vl);
+    if (first >= 0)
+      return i + first;
+    i += vl;
+  }
+#endif
+
+  return i + RTML_upper_bound_scalar(times + i, n - i, t);
+}
+
+#endif //_SEARCH_COMPAT_H_
@@ -0,0 +1,134 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RTML_SHARDEDBUFFER_H_
+#define _RTML_SHARDEDBUFFER_H_
+
+#include "circularbuffer.h"
+#include "reader.h"
+
+#ifndef __HW__
+#include <atomic>
+#endif
+
+/**
+ * The default policy of the shards of a RTML_sharded_buffer: each shard has
+ * one writer (see RTML_single_producer).
+ */
+struct RTML_shard_policy : RTML_buffer_policy {
+  typedef RTML_single_producer writer_protocol;
+};
+
+/**
+ * RTML_sharded_buffer splits a trace into K buffers of N events, one for
+ * each producer thread (or core), so that producers do not contend on a
+ * single buffer. Each shard is a RTML_buffer with its own writer and a
+ * RMTLD3_merge_reader reads the shards as one trace ordered by timestamps.
+ *
+ * \code
+ * typedef RTML_sharded_buffer<Event<int>, 100, 4> sharded_t;
+ * sharded_t __buffer;
+ *
+ * // each producer thread
+ * sharded_t::shard_t *shard = __buffer.claim();
+ * RTML_writer<sharded_t::shard_t> writer(*shard);
+ *
+ * // monitor
+ * RMTLD3_merge_reader<sharded_t> trace(__buffer);
+ * \endcode
+ *
+ * @see RTML_buffer
+ * @see RMTLD3_merge_reader
+ */
+template <typename T, size_t N, size_t K, typename P = RTML_shard_policy>
+class RTML_sharded_buffer {
+public:
+  typedef T event_t;
+
+  typedef RTML_buffer<T, N, P> shard_t;
+
+  /**
+   * The number of shards
+   */
+  static const size_t shards = K;
+
+private:
+  shard_t shard_array[K];
+
+#ifndef __HW__
+  /**
+   * The number of shards given to producers by claim
+   */
+  std::atomic<size_t> claimed;
+#endif
+
+public:
+  RTML_sharded_buffer();
+
+  /**
+   * Get the shard at the index
+   */
+  shard_t &shard(size_t index) { return shard_array[index]; }
+  const shard_t &shard(size_t index) const { return shard_array[index]; }
+
+#ifndef __HW__
+  /**
+   * Give a shard that no producer has claimed yet, in order, to the calling
+   * producer. It is safe to call from concurrent threads.
+   *
+   * @return the shard, or NULL when all shards have been claimed.
+   */
+  shard_t *claim();
+#endif
+
+  /**
+   * Get the number of events in all shards
+   */
+  size_t length() const;
+};
+
+#ifndef __HW__
+template <typename T, size_t N, size_t K, typename P>
+RTML_sharded_buffer<T, N, K, P>::RTML_sharded_buffer() : claimed(0) {}
+
+template <typename T, size_t N, size_t K, typename P>
+typename RTML_sharded_buffer<T, N, K, P>::shard_t *
+RTML_sharded_buffer<T, N, K, P>::claim() {
+  size_t index = claimed.fetch_add(1, std::memory_order_relaxed);
+
+  return (index < K) ? &shard_array[index] : NULL;
+}
+#else
+template <typename T, size_t N, size_t K, typename P>
+RTML_sharded_buffer<T, N, K, P>::RTML_sharded_buffer() {}
+#endif
+
+template <typename T, size_t N, size_t K, typename P>
+size_t RTML_sharded_buffer<T, N, K, P>::length() const {
+  size_t n = 0;
+
+  for (size_t i = 0; i < K; i++)
+    n += shard_array[i].length();
+
+  return n;
+}
+
+#endif //_RTML_SHARDEDBUFFER_H_
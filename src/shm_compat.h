@@ -0,0 +1,239 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SHM_COMPAT_H_
+#define _SHM_COMPAT_H_
+
+#include "circularbuffer.h"
+
+/**
+ * A RTML_buffer is position independent when it holds no pointer into the
+ * address space of a process, i.e. unless page swap writers refer to their
+ * states by address.
+ */
+template <typename W, typename M> struct RTML_position_independent {
+  static const bool value = true;
+};
+
+template <>
+struct RTML_position_independent<RTML_page_swap, RTML_absolute_address> {
+  static const bool value = false;
+};
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <errno.h>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Places a RTML_buffer in a POSIX shared memory segment, so that a monitor
+ * in another process reads the events of an application without copying
+ * them. The segment may be mapped at a different address in each process.
+ *
+ * \code
+ * struct shared_policy : RTML_buffer_policy {
+ *   typedef RTML_relative_address<4> address_mode;
+ * };
+ *
+ * typedef RTML_buffer<Event<int>, 100, shared_policy> buffer_t;
+ *
+ * // application
+ * RTML_shared_buffer<buffer_t> shm;
+ * shm.create("/rtml_trace");
+ * RTML_writer<buffer_t> writer = RTML_writer<buffer_t>(shm.buffer());
+ *
+ * // monitor
+ * RTML_shared_buffer<buffer_t> shm;
+ * shm.attach("/rtml_trace");
+ * RTML_reader<buffer_t> reader = RTML_reader<buffer_t>(shm.buffer());
+ * \endcode
+ *
+ * \warning
+ * The atomics of the buffer must be lock-free to be shared between
+ * processes; on x86_64 the page is swapped with cmpxchg16b (-mcx16).
+ *
+ * @see RTML_relative_address
+ */
+template <typename B> class RTML_shared_buffer {
+  static_assert(RTML_position_independent<
+                    typename B::writer_protocol,
+                    typename B::address_mode>::value,
+                "page swap buffers in shared memory require "
+                "RTML_relative_address");
+
+  // the spill is mapped at an address of the process that created it
+  static_assert(!std::is_same<typename B::spill_mode, RTML_file_spill>::value,
+                "RTML_file_spill can not be shared between processes");
+
+  /**
+   * The layout of the segment
+   */
+  struct segment {
+    uint32_t magic;
+    uint32_t size;
+    std::atomic<uint32_t> ready;
+    B buffer;
+  };
+
+  static const uint32_t MAGIC = 0x52544d4c; // RTML
+
+  segment *seg;
+
+public:
+  typedef enum { OK = 0, EXISTS, NOT_FOUND, INCOMPATIBLE, FAILED } error_t;
+
+private:
+  /**
+   * Map the segment of the file descriptor and close it
+   */
+  error_t map(int);
+
+public:
+
+  RTML_shared_buffer() : seg(NULL) {}
+
+  ~RTML_shared_buffer() { detach(); }
+
+  /**
+   * Create the named segment and construct the buffer in it. It fails with
+   * EXISTS if the segment already exists.
+   */
+  error_t create(const char *name);
+
+  /**
+   * Map the named segment of a buffer constructed by another process. It
+   * fails with INCOMPATIBLE while the buffer is not constructed yet or when
+   * the segment holds another type of buffer.
+   */
+  error_t attach(const char *name);
+
+  /**
+   * Unmap the segment; the buffer is left for the other processes
+   */
+  void detach();
+
+  /**
+   * Remove the named segment once every process has detached
+   */
+  static error_t unlink(const char *name);
+
+  /**
+   * Get the buffer in the segment (only valid once created or attached)
+   */
+  B &buffer() { return seg->buffer; }
+};
+
+template <typename B>
+typename RTML_shared_buffer<B>::error_t
+RTML_shared_buffer<B>::create(const char *name) {
+  detach();
+
+  int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+    return (errno == EEXIST) ? EXISTS : FAILED;
+
+  if (ftruncate(fd, sizeof(segment)) != 0) {
+    close(fd);
+    shm_unlink(name);
+    return FAILED;
+  }
+
+  error_t err = map(fd);
+  if (err != OK) {
+    shm_unlink(name);
+    return err;
+  }
+
+  seg->magic = MAGIC;
+  seg->size = sizeof(segment);
+  new (&seg->buffer) B();
+
+  // the buffer is visible to attach only once it is constructed
+  seg->ready.store(1, std::memory_order_release);
+
+  return OK;
+}
+
+template <typename B>
+typename RTML_shared_buffer<B>::error_t
+RTML_shared_buffer<B>::attach(const char *name) {
+  detach();
+
+  int fd = shm_open(name, O_RDWR, 0600);
+  if (fd < 0)
+    return (errno == ENOENT) ? NOT_FOUND : FAILED;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size != (off_t)sizeof(segment)) {
+    close(fd);
+    return INCOMPATIBLE;
+  }
+
+  error_t err = map(fd);
+  if (err != OK)
+    return err;
+
+  if (seg->ready.load(std::memory_order_acquire) != 1 ||
+      seg->magic != MAGIC || seg->size != sizeof(segment)) {
+    detach();
+    return INCOMPATIBLE;
+  }
+
+  return OK;
+}
+
+template <typename B>
+typename RTML_shared_buffer<B>::error_t RTML_shared_buffer<B>::map(int fd) {
+  void *addr = mmap(NULL, sizeof(segment), PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+  close(fd);
+
+  if (addr == MAP_FAILED)
+    return FAILED;
+
+  seg = (segment *)addr;
+
+  return OK;
+}
+
+template <typename B> void RTML_shared_buffer<B>::detach() {
+  if (seg != NULL) {
+    munmap(seg, sizeof(segment));
+    seg = NULL;
+  }
+}
+
+template <typename B>
+typename RTML_shared_buffer<B>::error_t
+RTML_shared_buffer<B>::unlink(const char *name) {
+  return (shm_unlink(name) == 0) ? OK : NOT_FOUND;
+}
+
+#else
+#warning "Shared memory buffers are not supported!"
+#endif
+
+#endif //_SHM_COMPAT_H_
@@ -0,0 +1,154 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SPILL_COMPAT_H_
+#define _SPILL_COMPAT_H_
+
+#include "circularbuffer.h"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * Maps the spill ring of a RTML_buffer with RTML_file_spill to a file, so
+ * that events overwritten in the buffer are kept on disk for the readers
+ * behind it (see RTML_reader::synchronize). The file keeps a header and
+ * capacity records of one event and its sequence number each.
+ *
+ * \code
+ * struct spill_policy : RTML_buffer_policy {
+ *   typedef RTML_sequence_gap gap_detection;
+ *   typedef RTML_file_spill spill;
+ * };
+ *
+ * RTML_buffer<Event<int>, 100, spill_policy> __buffer;
+ * RTML_spill_file<RTML_buffer<Event<int>, 100, spill_policy>> spill;
+ * spill.create("/var/tmp/rtml_spill", 1 << 20, __buffer);
+ * \endcode
+ *
+ * \warning
+ * The file must be attached before the writers start and detached after they
+ * stop.
+ */
+template <typename B> class RTML_spill_file {
+  static_assert(std::is_same<typename B::spill_mode, RTML_file_spill>::value,
+                "RTML_spill_file requires RTML_file_spill");
+
+  typedef typename B::event_t event_t;
+
+  typedef RTML_spill_record<event_t> record_t;
+
+  /**
+   * The header of the file; the records start at the next cache line
+   */
+  struct header {
+    uint32_t magic;
+    uint32_t record_size;
+    uint64_t capacity;
+  };
+
+  static const uint32_t MAGIC = 0x52544d53; // RTMS
+
+  static const size_t OFFSET =
+      (sizeof(header) + RTML_CACHE_LINE_SIZE - 1) / RTML_CACHE_LINE_SIZE *
+      RTML_CACHE_LINE_SIZE;
+
+  void *addr;
+  size_t bytes;
+  B *buf;
+
+public:
+  typedef enum { OK = 0, FAILED } error_t;
+
+  RTML_spill_file() : addr(NULL), bytes(0), buf(NULL) {}
+
+  ~RTML_spill_file() { detach(); }
+
+  /**
+   * Create (or truncate) the file with room for capacity events and attach
+   * it to the spill of the buffer
+   */
+  error_t create(const char *path, size_t capacity, B &buffer);
+
+  /**
+   * Detach the file from the buffer and unmap it; the file is left on disk
+   */
+  void detach();
+};
+
+template <typename B>
+typename RTML_spill_file<B>::error_t
+RTML_spill_file<B>::create(const char *path, size_t capacity, B &buffer) {
+  detach();
+
+  if (capacity == 0)
+    return FAILED;
+
+  int fd = open(path, O_CREAT | O_TRUNC | O_RDWR, 0600);
+  if (fd < 0)
+    return FAILED;
+
+  size_t size = OFFSET + capacity * sizeof(record_t);
+
+  // the file is zero filled, i.e. every record is empty
+  if (ftruncate(fd, (off_t)size) != 0) {
+    close(fd);
+    return FAILED;
+  }
+
+  void *a = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (a == MAP_FAILED)
+    return FAILED;
+
+  header *h = (header *)a;
+  h->magic = MAGIC;
+  h->record_size = sizeof(record_t);
+  h->capacity = capacity;
+
+  addr = a;
+  bytes = size;
+  buf = &buffer;
+
+  buffer.spill.capacity = capacity;
+  buffer.spill.records = (record_t *)((char *)a + OFFSET);
+
+  return OK;
+}
+
+template <typename B> void RTML_spill_file<B>::detach() {
+  if (addr != NULL) {
+    buf->spill.records = NULL;
+    munmap(addr, bytes);
+    addr = NULL;
+    buf = NULL;
+  }
+}
+
+#else
+#warning "Spill files are not supported!"
+#endif
+
+#endif //_SPILL_COMPAT_H_
@@ -140,6 +140,16 @@ struct task {
 
   void *run_payload;
 
+  /**
+   * The notification channel that wakes the task before its next period and
+   * how to wait on it (see RTML_monitor::wakeup)
+   */
+  bool (*wait_notification)(void *, uint32_t *, const struct timespec *);
+
+  void *notification;
+
+  uint32_t notified;
+
   int create_task(void *(*loop)(void *), const int pri, const int s_policy,
                   int stack_size = STACK_SIZE) {
     pthread_attr_t attribute = {0};
@@ -176,11 +186,13 @@ struct task {
   task(char const *id, void *(*loop)(void *), const int prio,
        const int sch_policy, const useconds_t p, void *payload = NULL)
       : tid(id), period(p), sched_policy(sch_policy), priority(prio), run(loop),
-        run_payload(payload) {
+        run_payload(payload), wait_notification(NULL), notification(NULL),
+        notified(0) {
     create_task(
         [](void *tsk) -> void * {
           struct task *ttask = (struct task *)tsk;
           struct timespec now = {0}, next = {0}, tmp = {0};
+          bool notified = false;
 
           DEBUGV("#Task(%s) is waiting ...\n", ttask->tid);
 
@@ -213,6 +225,10 @@ struct task {
             DEBUGV3_APPEND("sizeof(struct timespec)=0x%x job_time%lus.%luns ",
                            sizeof(struct timespec), L(now.tv_sec), now.tv_nsec);
 
+            // a job released by a notification keeps the next wake up
+            if (notified)
+              goto wait;
+
             DEBUGV3_APPEND("period=%luus ", ttask->period);
 
             // convert useconds_t to struct timespec
@@ -237,11 +253,17 @@ struct task {
                            ttask->tid, L(tmp.tv_sec), tmp.tv_nsec);
             }
 
-            pthread_mutex_lock(&ttask->fmtx);
-            pcheck_print(
-                pthread_cond_timedwait(&ttask->cond, &ttask->fmtx, &next),
-                ETIMEDOUT, break;);
-            pthread_mutex_unlock(&ttask->fmtx);
+          wait:
+            if (ttask->wait_notification != NULL) {
+              notified = ttask->wait_notification(ttask->notification,
+                                                  &ttask->notified, &next);
+            } else {
+              pthread_mutex_lock(&ttask->fmtx);
+              pcheck_print(
+                  pthread_cond_timedwait(&ttask->cond, &ttask->fmtx, &next),
+                  ETIMEDOUT, break;);
+              pthread_mutex_unlock(&ttask->fmtx);
+            }
 
             if (ttask->st == ABORT) {
               ttask->st = ABORTED;
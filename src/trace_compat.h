@@ -0,0 +1,733 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TRACE_COMPAT_H_
+#define _TRACE_COMPAT_H_
+
+#include "buffer_policy.h"
+#include "event.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Binary trace files keep the events that flowed through a RTML_buffer, so
+ * that monitors evaluate them offline. A file has, in host byte order:
+ *
+ * - a header (RTML_trace_header),
+ * - a dictionary with the name of each proposition: its id, the length of
+ *   its name and the name, padded to 8 bytes, and
+ * - blocks of events, starting at the next 64 bytes. Each block has a
+ *   header (RTML_trace_block) and block_events events, except the last one
+ *   that has the remaining events.
+ *
+ * RTML_trace_recorder writes a file from a reader and RTML_trace_buffer maps
+ * it as a buffer for RTML_reader and RMTLD3_reader.
+ */
+struct RTML_trace_header {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t time_size;
+  uint32_t event_size;
+  uint32_t block_events;
+  uint64_t events;
+  uint64_t blocks;
+  uint32_t propositions;
+  uint32_t dictionary_size;
+};
+
+struct RTML_trace_block {
+  uint64_t events;
+  int64_t first;
+  int64_t last;
+  uint64_t reserved;
+};
+
+static const uint32_t RTML_TRACE_MAGIC = 0x544d5452; // RTMT
+static const uint16_t RTML_TRACE_VERSION = 1;
+
+/**
+ * The offset of the first block of a trace with a dictionary of the size
+ */
+inline size_t RTML_trace_data(size_t dictionary_size) {
+  return (sizeof(RTML_trace_header) + dictionary_size + 63) / 64 * 64;
+}
+
+/**
+ * Writes the events of type T to a trace file in blocks of E events. Names
+ * of propositions are added before the first event.
+ *
+ * \code
+ * RTML_trace_recorder<Event<int>> recorder;
+ * recorder.create("trace.rtmt");
+ * recorder.proposition(1, "a");
+ * size_t count;
+ * while (running)
+ *   recorder.record(reader, count);
+ * recorder.close();
+ * \endcode
+ */
+template <typename T, size_t E = 4096> class RTML_trace_recorder {
+  int fd;
+
+  RTML_trace_header header;
+
+  /**
+   * The dictionary, written before the first block
+   */
+  char *dictionary;
+
+  /**
+   * The block being filled
+   */
+  RTML_trace_block block;
+  T events[E];
+
+  /**
+   * Write the bytes at the offset of the file
+   */
+  bool put(const void *, size_t, off_t);
+
+  /**
+   * Write the block being filled
+   */
+  bool flush();
+
+  /**
+   * Add the event at the end of the block being filled, unless its
+   * timestamp is before the one of the last event appended
+   */
+  bool add(const T &);
+
+  RTML_trace_recorder(const RTML_trace_recorder &) = delete;
+  RTML_trace_recorder &operator=(const RTML_trace_recorder &) = delete;
+
+public:
+  typedef enum { OK = 0, FAILED } error_t;
+
+  RTML_trace_recorder() : fd(-1), dictionary(NULL) {}
+
+  ~RTML_trace_recorder() { close(); }
+
+  /**
+   * Create (or truncate) the trace file
+   */
+  error_t create(const char *path);
+
+  /**
+   * Name the proposition with the id. It fails once events are recorded.
+   */
+  error_t proposition(uint32_t id, const char *name);
+
+  /**
+   * Append count events. Their timestamps must not decrease: append fails
+   * at the first event before the last one appended, and the events from
+   * it on are not appended.
+   */
+  error_t append(const T *, size_t count);
+
+  /**
+   * Pull every event available to the reader and append it. The reader is
+   * synchronized again after a gap, so the events lost in the buffer are
+   * missing in the trace. As with append, recording fails at the first
+   * event with a decreasing timestamp, and the events pulled with it are
+   * lost.
+   *
+   * @param count the number of events appended.
+   */
+  template <typename R> error_t record(R &reader, size_t &count);
+
+  /**
+   * Write the last block and the header, and close the file
+   */
+  error_t close();
+};
+
+template <typename T, size_t E>
+bool RTML_trace_recorder<T, E>::put(const void *data, size_t size,
+                                    off_t offset) {
+  const char *p = (const char *)data;
+
+  while (size > 0) {
+    ssize_t n = pwrite(fd, p, size, offset);
+    if (n <= 0)
+      return false;
+    p += n;
+    size -= n;
+    offset += n;
+  }
+
+  return true;
+}
+
+template <typename T, size_t E>
+typename RTML_trace_recorder<T, E>::error_t
+RTML_trace_recorder<T, E>::create(const char *path) {
+  close();
+
+  fd = open(path, O_CREAT | O_TRUNC | O_RDWR, 0644);
+  if (fd < 0)
+    return FAILED;
+
+  memset(&header, 0, sizeof(header));
+  header.magic = RTML_TRACE_MAGIC;
+  header.version = RTML_TRACE_VERSION;
+  header.time_size = sizeof(timespan);
+  header.event_size = sizeof(T);
+  header.block_events = E;
+
+  memset(&block, 0, sizeof(block));
+
+  return OK;
+}
+
+template <typename T, size_t E>
+typename RTML_trace_recorder<T, E>::error_t
+RTML_trace_recorder<T, E>::proposition(uint32_t id, const char *name) {
+  if (fd < 0 || header.events > 0 || block.events > 0)
+    return FAILED;
+
+  uint32_t length = strlen(name);
+  size_t entry = (2 * sizeof(uint32_t) + length + 7) / 8 * 8;
+
+  char *d = (char *)realloc(dictionary, header.dictionary_size + entry);
+  if (d == NULL)
+    return FAILED;
+
+  char *p = d + header.dictionary_size;
+  memset(p, 0, entry);
+  memcpy(p, &id, sizeof(id));
+  memcpy(p + sizeof(id), &length, sizeof(length));
+  memcpy(p + 2 * sizeof(uint32_t), name, length);
+
+  dictionary = d;
+  header.dictionary_size += entry;
+  header.propositions++;
+
+  return OK;
+}
+
+template <typename T, size_t E> bool RTML_trace_recorder<T, E>::flush() {
+  if (block.events == 0)
+    return true;
+
+  size_t bytes = sizeof(RTML_trace_block) + E * sizeof(T);
+  off_t offset =
+      RTML_trace_data(header.dictionary_size) + header.blocks * bytes;
+
+  if (!put(&block, sizeof(block), offset) ||
+      !put(events, block.events * sizeof(T), offset + sizeof(block)))
+    return false;
+
+  header.events += block.events;
+  header.blocks++;
+  block.events = 0;
+
+  return true;
+}
+
+template <typename T, size_t E>
+bool RTML_trace_recorder<T, E>::add(const T &event) {
+  // block.last is kept by flush, so it is the time of the last event
+  if ((header.events > 0 || block.events > 0) && event.getTime() < block.last)
+    return false;
+
+  if (block.events == 0)
+    block.first = event.getTime();
+  block.last = event.getTime();
+  events[block.events++] = event;
+
+  return true;
+}
+
+template <typename T, size_t E>
+typename RTML_trace_recorder<T, E>::error_t
+RTML_trace_recorder<T, E>::append(const T *data, size_t count) {
+  if (fd < 0)
+    return FAILED;
+
+  for (size_t i = 0; i < count; i++)
+    if (!add(data[i]) || (block.events == E && !flush()))
+      return FAILED;
+
+  return OK;
+}
+
+template <typename T, size_t E>
+template <typename R>
+typename RTML_trace_recorder<T, E>::error_t
+RTML_trace_recorder<T, E>::record(R &reader, size_t &count) {
+  count = 0;
+
+  if (fd < 0)
+    return FAILED;
+
+  reader.synchronize();
+
+  while (true) {
+    // the events are pulled past the block, and added in place
+    size_t n;
+    typename R::error_t err = reader.pull_n(events + block.events,
+                                            E - block.events, n);
+
+    for (size_t i = 0; i < n; i++) {
+      if (!add(events[block.events]))
+        return FAILED;
+      count++;
+    }
+
+    if (block.events == E && !flush())
+      return FAILED;
+
+    if (err == reader.READER_OVERFLOW || err == reader.READ_ERROR)
+      reader.synchronize();
+    else if (n == 0)
+      return OK;
+  }
+}
+
+template <typename T, size_t E>
+typename RTML_trace_recorder<T, E>::error_t
+RTML_trace_recorder<T, E>::close() {
+  if (fd < 0)
+    return OK;
+
+  bool ok = flush() && put(&header, sizeof(header), 0) &&
+            (header.dictionary_size == 0 ||
+             put(dictionary, header.dictionary_size, sizeof(header)));
+
+  ::close(fd);
+  fd = -1;
+  free(dictionary);
+  dictionary = NULL;
+
+  return ok ? OK : FAILED;
+}
+
+/**
+ * The index of the events of a RTML_trace_buffer, which do not wrap around
+ */
+struct RTML_trace_index {
+  static size_t next(size_t i) { return i + 1; }
+
+  static size_t prev(size_t i) { return i - 1; }
+
+  static size_t advance(size_t i, size_t n) { return i + n; }
+
+  static size_t retreat(size_t i, size_t n) { return i - n; }
+
+  static size_t distance(size_t b, size_t t) { return t - b; }
+
+  template <typename C> static size_t slot(C seq) { return seq; }
+};
+
+/**
+ * Maps a trace file (see RTML_trace_recorder) read-only and reads it as a
+ * RTML_buffer that holds all its events, so that RTML_reader and
+ * RMTLD3_reader, and the monitors built on them, evaluate traces of any
+ * length at the speed of memory. Events are read in place from the mapping.
+ *
+ * \code
+ * RTML_trace_buffer<Event<int>> trace;
+ * trace.open("trace.rtmt");
+ * RMTLD3_reader<RTML_reader<RTML_trace_buffer<Event<int>>>, int> reader(
+ *     trace, tzero);
+ * reader.synchronize();
+ * \endcode
+ */
+template <typename T> class RTML_trace_buffer {
+  const char *addr;
+  size_t bytes;
+
+  const RTML_trace_header *header;
+
+  /**
+   * The first block and the size of a full block
+   */
+  const char *data;
+  size_t block_bytes;
+
+  RTML_trace_buffer(const RTML_trace_buffer &) = delete;
+  RTML_trace_buffer &operator=(const RTML_trace_buffer &) = delete;
+
+  /**
+   * Get the id and the name length of the entry of the dictionary at p and
+   * move p to the next entry. It fails when the entry does not lie inside
+   * the dictionary.
+   */
+  bool entry(const char *&, uint32_t &, uint32_t &) const;
+
+public:
+  typedef T event_t;
+
+  typedef RTML_trace_index index_t;
+
+  typedef RTML_timestamp_gap gap_detection;
+
+  typedef enum {
+    OK = 0,
+    EMPTY,
+    BUFFER_OVERFLOW,
+    OUT_OF_BOUND,
+    UNSAFE,
+    TORN
+  } error_t;
+
+  typedef enum { OPENED = 0, NOT_FOUND, INCOMPATIBLE } open_error_t;
+
+  /**
+   * The number of events of the trace
+   */
+  size_t size;
+  size_t size_util;
+
+  RTML_trace_buffer()
+      : addr(NULL), bytes(0), header(NULL), data(NULL), block_bytes(0),
+        size(0), size_util(0) {}
+
+  ~RTML_trace_buffer() { close(); }
+
+  /**
+   * Map the trace file. It fails with INCOMPATIBLE when the file is not a
+   * trace of events of type T.
+   */
+  open_error_t open(const char *path);
+
+  /**
+   * Unmap the trace file
+   */
+  void close();
+
+  /**
+   * Get the event at the index in place
+   */
+  const T &at(size_t index) const {
+    return *(const T *)(data + index / header->block_events * block_bytes +
+                        sizeof(RTML_trace_block) +
+                        index % header->block_events * sizeof(T));
+  }
+
+  /**
+   * Get the event at the index
+   */
+  error_t read(event_t &, size_t) const;
+
+  /**
+   * Get consecutive events from the index
+   */
+  error_t read(event_t *, size_t, size_t) const;
+
+  /**
+   * Get the timestamp of the event at the index
+   */
+  error_t read_time(timespan &, size_t) const;
+
+  /**
+   * Get the number of the count events from the index whose timestamps are
+   * up to t (see RTML_buffer::upper_bound)
+   */
+  size_t upper_bound(const timespan &, size_t, size_t) const;
+
+  /**
+   * Get the state of the trace: all its events
+   */
+  error_t state(size_t &, size_t &) const;
+  error_t state(size_t &, size_t &, timespanw &, timespanw &) const;
+
+  size_t length() const { return size; }
+
+  /**
+   * Ask the kernel to read the count events from the index ahead of their
+   * use
+   */
+  void prefetch(size_t, size_t) const;
+
+  /**
+   * Drop the pages of the events before the index from memory; they are read
+   * from the file again if needed
+   */
+  void release(size_t) const;
+
+  /**
+   * Get the number of propositions in the dictionary
+   */
+  size_t propositions() const { return header ? header->propositions : 0; }
+
+  /**
+   * Get the id and the name (not terminated) of the i-th proposition of the
+   * dictionary
+   */
+  bool proposition(size_t, uint32_t &, const char *&, uint32_t &) const;
+
+  void debug() const {}
+};
+
+template <typename T>
+typename RTML_trace_buffer<T>::open_error_t
+RTML_trace_buffer<T>::open(const char *path) {
+  close();
+
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0)
+    return NOT_FOUND;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(RTML_trace_header)) {
+    ::close(fd);
+    return INCOMPATIBLE;
+  }
+
+  void *a = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if (a == MAP_FAILED)
+    return INCOMPATIBLE;
+
+  addr = (const char *)a;
+  bytes = st.st_size;
+  header = (const RTML_trace_header *)addr;
+
+  if (header->magic != RTML_TRACE_MAGIC ||
+      header->version != RTML_TRACE_VERSION ||
+      header->time_size != sizeof(timespan) ||
+      header->event_size != sizeof(T) || header->block_events == 0) {
+    close();
+    return INCOMPATIBLE;
+  }
+
+  const size_t offset = RTML_trace_data(header->dictionary_size);
+  block_bytes =
+      sizeof(RTML_trace_block) + (size_t)header->block_events * sizeof(T);
+
+  // the blocks before the last one fit in the file, which bounds the
+  // products below; a corrupt count can not wrap them around
+  if (offset > bytes ||
+      (header->blocks > 0 &&
+       header->blocks - 1 > (bytes - offset) / block_bytes) ||
+      header->events > header->blocks * header->block_events ||
+      (header->blocks > 0 &&
+       header->events <= (header->blocks - 1) * header->block_events)) {
+    close();
+    return INCOMPATIBLE;
+  }
+
+  // the last block is written up to its last event
+  size_t end = offset;
+  if (header->blocks > 0)
+    end += (header->blocks - 1) * block_bytes + sizeof(RTML_trace_block) +
+           (header->events - (header->blocks - 1) * header->block_events) *
+               sizeof(T);
+
+  if (end > bytes) {
+    close();
+    return INCOMPATIBLE;
+  }
+
+  // the entries of the dictionary are checked once for proposition
+  const char *p = addr + sizeof(RTML_trace_header);
+  uint32_t id, length;
+
+  for (uint32_t k = 0; k < header->propositions; k++)
+    if (!entry(p, id, length)) {
+      close();
+      return INCOMPATIBLE;
+    }
+
+  data = addr + offset;
+  size = size_util = header->events;
+
+  // the events are mostly read in order
+  madvise(a, bytes, MADV_SEQUENTIAL);
+
+  return OPENED;
+}
+
+template <typename T> void RTML_trace_buffer<T>::close() {
+  if (addr != NULL) {
+    munmap((void *)addr, bytes);
+    addr = NULL;
+    header = NULL;
+    data = NULL;
+    size = size_util = 0;
+  }
+}
+
+template <typename T>
+typename RTML_trace_buffer<T>::error_t
+RTML_trace_buffer<T>::read(event_t &event, size_t index) const {
+  if (index >= size)
+    return OUT_OF_BOUND;
+
+  event = at(index);
+
+  return OK;
+}
+
+template <typename T>
+typename RTML_trace_buffer<T>::error_t
+RTML_trace_buffer<T>::read(event_t *events, size_t count,
+                           size_t index) const {
+  if (index + count > size)
+    return OUT_OF_BOUND;
+
+  // copy the run of each block at once
+  while (count > 0) {
+    size_t run = header->block_events - index % header->block_events;
+    run = (run < count) ? run : count;
+
+    memcpy(events, &at(index), run * sizeof(T));
+    events += run;
+    index += run;
+    count -= run;
+  }
+
+  return OK;
+}
+
+template <typename T>
+typename RTML_trace_buffer<T>::error_t
+RTML_trace_buffer<T>::read_time(timespan &t, size_t index) const {
+  if (index >= size)
+    return OUT_OF_BOUND;
+
+  t = at(index).getTime();
+
+  return OK;
+}
+
+template <typename T>
+size_t RTML_trace_buffer<T>::upper_bound(const timespan &t, size_t index,
+                                         size_t count) const {
+  size_t lo = 0, hi = count;
+
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+
+    if (at(index + mid).getTime() <= t)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+template <typename T>
+typename RTML_trace_buffer<T>::error_t
+RTML_trace_buffer<T>::state(size_t &b, size_t &t) const {
+  b = 0;
+  t = size;
+
+  return OK;
+}
+
+template <typename T>
+typename RTML_trace_buffer<T>::error_t
+RTML_trace_buffer<T>::state(size_t &b, size_t &t, timespanw &ts,
+                            timespanw &ts_t) const {
+  state(b, t);
+
+  ts = (size > 0) ? at(0).getTime() : 0;
+  ts_t = (size > 0) ? at(size - 1).getTime() : 0;
+
+  return OK;
+}
+
+template <typename T>
+void RTML_trace_buffer<T>::prefetch(size_t index, size_t count) const {
+  if (index >= size || count == 0)
+    return;
+
+  count = (count < size - index) ? count : size - index;
+
+  const size_t page = sysconf(_SC_PAGESIZE);
+  size_t from = ((const char *)&at(index) - addr) / page * page;
+  size_t to = (const char *)&at(index + count - 1) + sizeof(T) - addr;
+
+  madvise((void *)(addr + from), to - from, MADV_WILLNEED);
+}
+
+template <typename T> void RTML_trace_buffer<T>::release(size_t index) const {
+  if (index == 0 || index > size)
+    return;
+
+  // the pages of the header and of the event at the index are kept
+  const size_t page = sysconf(_SC_PAGESIZE);
+  size_t from = (data - addr + page - 1) / page * page;
+  size_t to = ((const char *)&at(index - 1) - addr) / page * page;
+
+  if (from < to)
+    madvise((void *)(addr + from), to - from, MADV_DONTNEED);
+}
+
+template <typename T>
+bool RTML_trace_buffer<T>::proposition(size_t i, uint32_t &id,
+                                       const char *&name,
+                                       uint32_t &length) const {
+  if (header == NULL || i >= header->propositions)
+    return false;
+
+  const char *p = addr + sizeof(RTML_trace_header);
+
+  for (size_t k = 0; k < i; k++)
+    if (!entry(p, id, length))
+      return false;
+
+  name = p + 2 * sizeof(uint32_t);
+
+  return entry(p, id, length);
+}
+
+template <typename T>
+bool RTML_trace_buffer<T>::entry(const char *&p, uint32_t &id,
+                                 uint32_t &length) const {
+  const char *end = addr + sizeof(RTML_trace_header) + header->dictionary_size;
+
+  if ((size_t)(end - p) < 2 * sizeof(uint32_t))
+    return false;
+
+  memcpy(&id, p, sizeof(id));
+  memcpy(&length, p + sizeof(id), sizeof(length));
+
+  // the entries are padded to 8 bytes
+  size_t step = (2 * sizeof(uint32_t) + (size_t)length + 7) / 8 * 8;
+
+  if ((size_t)(end - p) < step)
+    return false;
+
+  p += step;
+
+  return true;
+}
+
+#else
+#warning "Trace files are not supported!"
+#endif
+
+#endif //_TRACE_COMPAT_H_
@@ -49,12 +49,102 @@ private:
    */
   ATOMIC_PAGE_SWAP();
 
+#ifndef __HW__
+  /**
+   * The slot (page swap) or ticket (ticket) held between reserve and commit
+   */
+  sequence_t reserved;
+
+  /**
+   * The result of the push held between reserve and commit
+   */
+  typename B::error_t reserved_err;
+#endif
+
+  /**
+   * Whether the buffer lets this writer push (see RTML_single_producer and
+   * RTML_relative_address)
+   */
+  bool attached;
+
+#ifndef __HW__
+  /**
+   * The states of this writer kept in the buffer (see RTML_relative_address)
+   */
+  state_t *table;
+
+  /**
+   * Get the two states of this writer
+   */
+  state_t *states(RTML_absolute_address) { return state; }
+
+  template <unsigned W> state_t *states(RTML_relative_address<W>) {
+    return table;
+  }
+
+  /**
+   * Get a slot that is never published for a reserve that fails with the
+   * error, i.e., of a writer that is not attached or of an event that the
+   * storage can not keep
+   */
+  typename B::event_t &detached(typename B::error_t);
+
+  /**
+   * Check if commit has to publish the reserved slot
+   */
+  bool committable() const {
+    return reserved_err != buffer.UNSAFE && reserved_err != buffer.OUT_OF_BOUND;
+  }
+
+  /**
+   * The event built between reserve and commit when the storage of the
+   * buffer does not keep whole events (see RTML_delta_storage) or when the
+   * reserve fails
+   */
+  typename B::event_t staged;
+
+  /**
+   * The timestamp the slot is reserved with
+   */
+  timespan stamped;
+
+  /**
+   * Get the event that the reservation of the slot at the index is built in
+   */
+  typename B::event_t &reserved_slot(size_t index, RTML_event_storage) {
+    return buffer.slot(index);
+  }
+
+  template <typename M> typename B::event_t &reserved_slot(size_t, M) {
+    return staged;
+  }
+
+  /**
+   * Copy the event of the reservation into its slot before it is published
+   */
+  void settle(size_t, RTML_event_storage) {}
+
+  template <typename M> void settle(size_t index, M) {
+    // the storage may not keep a timestamp changed after the reserve
+    if (!buffer.fits(&staged, 1, index)) {
+      staged.setTime(stamped);
+      reserved_err = buffer.OUT_OF_BOUND;
+    }
+
+    buffer.place(staged, index);
+  }
+#endif
+
+  /**
+   * Attach this writer to the buffer
+   */
+  void attach();
+
   /**
    * Increment top of the writer
    */
   size_t &increment_writer_top(size_t &t) {
-    if (++t >= buffer.size)
-      t = 0;
+    t = B::index_t::next(t);
     return t;
   };
 
@@ -62,19 +152,104 @@ private:
    * Increment bottom of the writer
    */
   size_t &increment_writer_bottom(size_t &b) {
-    if (++b >= buffer.size)
-      b = 0;
+    b = B::index_t::next(b);
     return b;
   };
 
+#ifndef __HW__
+  /**
+   * Write the last pushed event on behalf of its writer (see
+   * RTML_help_completion). It returns false when the writer has to wait.
+   */
+  bool help(page_t, RTML_wait_completion) { return false; }
+  bool help(page_t, RTML_help_completion);
+
+  /**
+   * Notify the readers once n events, the last with the sequence number last,
+   * cross the watermark or one of them is urgent (see
+   * RTML_wakeup_notification)
+   */
+  void notify(const typename B::event_t *, size_t, sequence_t,
+              RTML_no_notification) {}
+  void notify(const typename B::event_t *, size_t, sequence_t,
+              RTML_wakeup_notification);
+
+  /**
+   * The timestamp of a page swap push that follows the last pushed event;
+   * the clock read before a retry may be older than the event of the writer
+   * that won the page
+   */
+  static timespan monotonic(timespan timestamp,
+                            const typename B::event_t &last) {
+    return (timestamp < last.getTime()) ? last.getTime() : timestamp;
+  }
+
+  /**
+   * Reserve count ticket slots. When stamp is true the clock is read before
+   * a compare-and-swap takes the slots, and read again after each failed
+   * swap, so the timestamps follow the order of the slots (lock-free);
+   * otherwise one fetch-and-add takes them (wait-free).
+   */
+  sequence_t take(size_t count, bool stamp, timespan &timestamp);
+#endif
+
+  /**
+   * Push an event using the writer protocol of the buffer. The event is
+   * timestamped when stamp is true.
+   */
+  typename B::error_t push(typename B::event_t &, bool, RTML_page_swap);
+
+#ifndef __HW__
+  typename B::error_t push(typename B::event_t &, bool, RTML_ticket);
+  typename B::error_t push(typename B::event_t &, bool, RTML_single_producer);
+#endif
+
+  /**
+   * Push consecutive events using the writer protocol of the buffer. The
+   * events are timestamped when stamp is true.
+   */
+  typename B::error_t push_n(typename B::event_t *, size_t, size_t &, bool,
+                             RTML_page_swap);
+
+#ifndef __HW__
+  typename B::error_t push_n(typename B::event_t *, size_t, size_t &, bool,
+                             RTML_ticket);
+  typename B::error_t push_n(typename B::event_t *, size_t, size_t &, bool,
+                             RTML_single_producer);
+#endif
+
+  /**
+   * Reserve and commit using the writer protocol of the buffer
+   */
+  typename B::event_t &reserve(RTML_page_swap);
+  typename B::error_t commit(RTML_page_swap);
+
+#ifndef __HW__
+  typename B::event_t &reserve(RTML_ticket);
+  typename B::error_t commit(RTML_ticket);
+  typename B::event_t &reserve(RTML_single_producer);
+  typename B::error_t commit(RTML_single_producer);
+#endif
+
 public:
   /**
-   * Instantiates a new RTML_writer.
+   * Instantiates a new RTML_writer. With RTML_single_producer, only the
+   * first writer attached to the buffer may push; the pushes of any other
+   * writer return UNSAFE.
    *
    * @param buffer the Buffer to write to.
    */
   RTML_writer(B &buffer);
 
+  /**
+   * Instantiates a new RTML_writer of the buffer of another one. The copy is
+   * attached to the buffer as any new writer, so it gets its own states and
+   * is subject to RTML_single_producer.
+   */
+  RTML_writer(const RTML_writer &);
+
+  RTML_writer &operator=(const RTML_writer &) = delete;
+
   /**
    * push an event to the Buffer.
    *
@@ -88,29 +263,190 @@ public:
    * @param data a constant reference to the data to be pushed.
    */
   typename B::error_t push_all(typename B::event_t &data);
+
+  /**
+   * push a burst of events to the Buffer with a single reservation. All
+   * events get the same timestamp.
+   *
+   * @param events a pointer to the events to be pushed.
+   * @param count the number of events.
+   * @param discarded the number of events overwritten to make room for the
+   * burst (including the oldest events of the burst when count is larger than
+   * the buffer).
+   */
+  typename B::error_t push_n(typename B::event_t *events, size_t count,
+                             size_t &discarded);
+
+  typename B::error_t push_n(typename B::event_t *events, size_t count);
+
+  /**
+   * force push a burst of events to the Buffer with a single reservation.
+   *
+   * @see push_n
+   */
+  typename B::error_t push_all_n(typename B::event_t *events, size_t count,
+                                 size_t &discarded);
+
+  typename B::error_t push_all_n(typename B::event_t *events, size_t count);
+
+  /**
+   * reserve the next slot of the Buffer. The event is built in place and
+   * becomes visible to readers with commit. The slot is timestamped when it
+   * is reserved.
+   *
+   * \warning
+   * Each reserve must be followed by a commit before any other push of this
+   * writer. With RTML_page_swap, the pushes of the other writers wait from
+   * reserve to commit, so the push is not lock-free.
+   *
+   * @return a reference to the event in the reserved slot.
+   */
+  typename B::event_t &reserve();
+
+  /**
+   * commit the slot obtained with reserve.
+   *
+   * @return the result of the push (BUFFER_OVERFLOW if an event has been
+   * discarded).
+   */
+  typename B::error_t commit();
 };
 
 template <typename B>
 RTML_writer<B>::RTML_writer(B &_buffer) : buffer(_buffer) {
-  buffer.increment_writer();
+  attach();
 }
 
 template <typename B>
-typename B::error_t RTML_writer<B>::push(typename B::event_t &event) {
+RTML_writer<B>::RTML_writer(const RTML_writer &writer)
+    : buffer(writer.buffer) {
+  attach();
+}
 
-  typename B::error_t err;
+template <typename B> void RTML_writer<B>::attach() {
+  attached = buffer.increment_writer();
+
+#ifndef __HW__
+  table = buffer.writer_states.attach();
+  attached = attached && states(typename B::address_mode()) != NULL;
+#endif
+}
+
+template <typename B>
+typename B::error_t RTML_writer<B>::push(typename B::event_t &event) {
 
 #if defined(__HW__)
 #error "Please use push_all instead!"
 #else
+  return push(event, true, typename B::writer_protocol());
+#endif
+}
+
+template <typename B>
+typename B::error_t RTML_writer<B>::push_all(typename B::event_t &event) {
+
+#if defined(__HW__)
+  return buffer.push(event);
+#else
+  return push(event, false, typename B::writer_protocol());
+#endif
+}
+
+template <typename B> typename B::event_t &RTML_writer<B>::reserve() {
+
+#if defined(__HW__)
+#error "reserve is not supported in hardware!"
+#else
+  return reserve(typename B::writer_protocol());
+#endif
+}
+
+template <typename B> typename B::error_t RTML_writer<B>::commit() {
+
+#if defined(__HW__)
+#error "commit is not supported in hardware!"
+#else
+  return commit(typename B::writer_protocol());
+#endif
+}
+
+template <typename B>
+typename B::error_t RTML_writer<B>::push_n(typename B::event_t *events,
+                                           size_t count, size_t &discarded) {
+
+#if defined(__HW__)
+#error "Please use push_all_n instead!"
+#else
+  return push_n(events, count, discarded, true, typename B::writer_protocol());
+#endif
+}
+
+template <typename B>
+typename B::error_t RTML_writer<B>::push_n(typename B::event_t *events,
+                                           size_t count) {
+  size_t discarded;
+  return push_n(events, count, discarded);
+}
+
+template <typename B>
+typename B::error_t RTML_writer<B>::push_all_n(typename B::event_t *events,
+                                               size_t count,
+                                               size_t &discarded) {
+
+#if defined(__HW__)
+  typename B::error_t err = buffer.OK;
+  discarded = 0;
+  for (size_t i = 0; i < count; i++)
+    if (buffer.push(events[i]) == buffer.BUFFER_OVERFLOW) {
+      err = buffer.BUFFER_OVERFLOW;
+      discarded++;
+    }
+  return err;
+#else
+  return push_n(events, count, discarded, false,
+                typename B::writer_protocol());
+#endif
+}
+
+template <typename B>
+typename B::error_t RTML_writer<B>::push_all_n(typename B::event_t *events,
+                                               size_t count) {
+  size_t discarded;
+  return push_all_n(events, count, discarded);
+}
+
+#if !defined(__HW__)
+
+template <typename B>
+typename B::error_t RTML_writer<B>::push(typename B::event_t &event,
+                                         bool stamp, RTML_page_swap) {
+
+  if (!attached)
+    return buffer.UNSAFE;
+
+  typename B::error_t err;
   size_t top;
+  sequence_t seq;
+
+  // the clock is read once; a retry keeps the timestamp no older than the
+  // last event pushed, so the trace stays monotonic
+  timespan timestamp = stamp ? B::clock_source_t::now() : 0;
 
   ATOMIC_PUSH({
-    timespan timestamp = clockgettime();
-    event.setTime(timestamp);
+    if (stamp) {
+      timespan t = monotonic(timestamp, evt);
+      event.setTime(t);
+    }
+
+    // leave without publishing an event that the storage can not keep
+    if (!buffer.fits(&event, 1, stateref->top)) {
+      err = buffer.OUT_OF_BOUND;
+      break;
+    }
 
     top = stateref->top;
     increment_writer_top(stateref->top);
+    seq = ++stateref->count;
 
     bool p = stateref->top == stateref->bottom;
 
@@ -120,26 +456,269 @@ typename B::error_t RTML_writer<B>::push(typename B::event_t &event) {
     err = (p) ? buffer.BUFFER_OVERFLOW : buffer.OK;
   });
 
-  buffer.write(event, top);
+  if (err == buffer.OUT_OF_BOUND)
+    return err;
 
-#endif
+  // a helper may have written the event already
+  if (buffer.seize(top, new_page_content.counter,
+                   typename B::completion_t())) {
+    buffer.write(event, top);
+    buffer.mark(top, seq);
+    buffer.release(top, typename B::completion_t());
+  }
+
+  notify(&event, 1, seq, typename B::notification());
 
   return err;
 }
 
 template <typename B>
-typename B::error_t RTML_writer<B>::push_all(typename B::event_t &event) {
+typename B::error_t RTML_writer<B>::push(typename B::event_t &event,
+                                         bool stamp, RTML_ticket) {
+
+  if (!attached)
+    return buffer.UNSAFE;
+
+  timespan timestamp;
+  sequence_t ticket = take(1, stamp, timestamp);
+
+  if (stamp)
+    event.setTime(timestamp);
+
+  buffer.claim(ticket);
+  buffer.write(event, B::index_t::slot(ticket));
+
+  buffer.control.publish(ticket);
+
+  notify(&event, 1, ticket + 1, typename B::notification());
+
+  return (ticket >= buffer.control.drop.load(std::memory_order_acquire) +
+                        buffer.size_util)
+             ? buffer.BUFFER_OVERFLOW
+             : buffer.OK;
+}
+
+template <typename B>
+typename B::error_t
+RTML_writer<B>::push_n(typename B::event_t *events, size_t count,
+                       size_t &discarded, bool stamp, RTML_page_swap) {
+
+  discarded = 0;
+  if (!attached)
+    return buffer.UNSAFE;
+
+  if (count == 0)
+    return buffer.OK;
+
+  // only the last size_util events of the burst can be kept
+  const size_t n = (count > buffer.size_util) ? buffer.size_util : count;
+  const size_t skip = count - n;
+
+  // the last event is the one checked for completion by the next push
+  typename B::event_t &event = events[count - 1];
 
   typename B::error_t err;
+  size_t top, last;
+  sequence_t seq;
 
-#if defined(__HW__)
-  err = buffer.push(event);
-#else
+  timespan timestamp = stamp ? B::clock_source_t::now() : 0;
+
+  ATOMIC_PUSH({
+    if (stamp) {
+      timespan t = monotonic(timestamp, evt);
+      for (size_t i = skip; i < count; i++)
+        events[i].setTime(t);
+    }
+
+    if (!buffer.fits(events + skip, n, stateref->top)) {
+      err = buffer.OUT_OF_BOUND;
+      break;
+    }
+
+    size_t len = B::index_t::distance(stateref->bottom, stateref->top);
+
+    size_t over = (len + n > buffer.size_util) ? len + n - buffer.size_util : 0;
+
+    // only this writer has the other events of the burst, so the burst is
+    // pending until they are written
+    stateref->pending = true;
+
+    top = stateref->top;
+    last = B::index_t::advance(top, n - 1);
+    stateref->pos = last;
+    stateref->top = B::index_t::advance(top, n);
+    stateref->bottom = B::index_t::advance(stateref->bottom, over);
+
+    // the events skipped from the burst are counted as pushed
+    seq = stateref->count + skip;
+    stateref->count += count;
+
+    discarded = over + skip;
+    err = (discarded > 0) ? buffer.BUFFER_OVERFLOW : buffer.OK;
+  });
+
+  if (err == buffer.OUT_OF_BOUND)
+    return err;
+
+  // a pending burst is written by its writer only
+  for (size_t i = 0; i < n; i++)
+    buffer.seize(B::index_t::advance(top, i), new_page_content.counter,
+                 typename B::completion_t());
+
+  buffer.write(events + skip, n - 1, top);
+  std::atomic_thread_fence(std::memory_order_release);
+  buffer.write(event, last);
+
+  for (size_t i = 0; i < n; i++) {
+    buffer.mark(B::index_t::advance(top, i), seq + i + 1);
+    buffer.release(B::index_t::advance(top, i), typename B::completion_t());
+  }
+
+  // the next push waits until the whole burst is written
+  std::atomic_thread_fence(std::memory_order_release);
+  *(volatile bool *)&stateref->pending = false;
+
+  notify(events + skip, n, seq + n, typename B::notification());
+
+  return err;
+}
+
+template <typename B>
+typename B::error_t
+RTML_writer<B>::push_n(typename B::event_t *events, size_t count,
+                       size_t &discarded, bool stamp, RTML_ticket) {
+
+  discarded = 0;
+  if (!attached)
+    return buffer.UNSAFE;
+
+  if (count == 0)
+    return buffer.OK;
+
+  const size_t n = (count > buffer.size_util) ? buffer.size_util : count;
+  const size_t skip = count - n;
+
+  // one reservation takes the whole burst
+  timespan timestamp;
+  sequence_t ticket = take(count, stamp, timestamp);
+
+  if (stamp) {
+    for (size_t i = skip; i < count; i++)
+      events[i].setTime(timestamp);
+  }
+
+  // the previous lap of a slot within the burst is a skipped ticket
+  for (size_t i = skip; i < count && i < buffer.size; i++)
+    buffer.claim(ticket + i);
+
+  buffer.write(events + skip, n, B::index_t::slot(ticket + skip));
+
+  for (size_t i = 0; i < count; i++)
+    buffer.control.publish(ticket + i);
+
+  notify(events + skip, n, ticket + count, typename B::notification());
+
+  sequence_t d = buffer.control.drop.load(std::memory_order_acquire);
+  size_t len = (d > ticket) ? 0
+               : (ticket - d > buffer.size_util) ? buffer.size_util
+                                                 : ticket - d;
+
+  discarded = (len + count > buffer.size_util)
+                  ? len + count - buffer.size_util
+                  : 0;
+
+  return (discarded > 0) ? buffer.BUFFER_OVERFLOW : buffer.OK;
+}
+
+template <typename B>
+void RTML_writer<B>::notify(const typename B::event_t *events, size_t n,
+                            sequence_t last, RTML_wakeup_notification) {
+
+  const size_t watermark = B::policy_t::watermark;
+  static_assert(watermark > 0, "the watermark must be positive");
+
+  // the pushed sequence numbers (last - n, last] cross a multiple of it
+  bool wake = last / watermark != (last - n) / watermark;
+
+  for (size_t i = 0; i < n && !wake; i++)
+    wake = B::policy_t::urgent(events[i]);
+
+  if (wake)
+    buffer.notifier.notify();
+}
+
+template <typename B>
+typename B::event_t &RTML_writer<B>::detached(typename B::error_t err) {
+
+  // the event is built aside and dropped by commit
+  reserved_err = err;
+
+  return staged;
+}
+
+template <typename B>
+bool RTML_writer<B>::help(page_t page, RTML_help_completion) {
+
+  state_t *s = buffer.resolve(page);
+
+  if (s->pending)
+    return false;
+
+  typename B::event_t event = s->event;
+  size_t pos = s->pos;
+  sequence_t count = s->count;
+
+  // the copy is consistent only if the page still refers to the state,
+  // otherwise its writer may be reusing it
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (((page_t)std::atomic_load(&buffer.page)).wide_uniqueid !=
+      page.wide_uniqueid)
+    return true;
+
+  // the slot may have been written since, even by a later lap of the ring
+  int claimed = buffer.slot_claim.acquire(pos, page.counter);
+  if (claimed < 0)
+    return false;
+
+  if (claimed > 0) {
+    buffer.write(event, pos);
+    buffer.mark(pos, count);
+    buffer.slot_claim.release(pos);
+  }
+
+  return true;
+}
+
+template <typename B>
+typename B::event_t &RTML_writer<B>::reserve(RTML_page_swap) {
+
+  if (!attached)
+    return detached(buffer.UNSAFE);
+
+  typename B::error_t err;
   size_t top;
+  timespan timestamp;
+
+  // the state is published as pending, so the completion check of the next
+  // push waits for the commit
+  typename B::event_t event;
+
+  const timespan now = B::clock_source_t::now();
 
   ATOMIC_PUSH({
+    timestamp = monotonic(now, evt);
+
+    event.setTime(timestamp);
+    if (!buffer.fits(&event, 1, stateref->top)) {
+      err = buffer.OUT_OF_BOUND;
+      break;
+    }
+
+    stateref->pending = true;
+
     top = stateref->top;
     increment_writer_top(stateref->top);
+    ++stateref->count;
 
     bool p = stateref->top == stateref->bottom;
 
@@ -149,11 +728,242 @@ typename B::error_t RTML_writer<B>::push_all(typename B::event_t &event) {
     err = (p) ? buffer.BUFFER_OVERFLOW : buffer.OK;
   });
 
-  buffer.write(event, top);
+  if (err == buffer.OUT_OF_BOUND)
+    return detached(err);
 
-#endif
+  reserved = top;
+  reserved_err = err;
+  stamped = timestamp;
 
-  return err;
+  buffer.seize(top, new_page_content.counter, typename B::completion_t());
+  buffer.begin_write(top);
+
+  typename B::event_t &slot = reserved_slot(top, typename B::storage());
+  slot.setTime(timestamp);
+
+  return slot;
+}
+
+template <typename B>
+typename B::error_t RTML_writer<B>::commit(RTML_page_swap) {
+
+  if (!committable())
+    return reserved_err;
+
+  typename B::event_t &slot = reserved_slot(reserved, typename B::storage());
+
+  settle(reserved, typename B::storage());
+  buffer.slot_version.end_write(reserved);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  // complete the state published by reserve
+  stateref->event = slot;
+  buffer.mark(reserved, stateref->count);
+  buffer.release(reserved, typename B::completion_t());
+
+  std::atomic_thread_fence(std::memory_order_release);
+  *(volatile bool *)&stateref->pending = false;
+
+  notify(&slot, 1, stateref->count, typename B::notification());
+
+  return reserved_err;
 }
 
+template <typename B>
+sequence_t RTML_writer<B>::take(size_t count, bool stamp,
+                                timespan &timestamp) {
+
+  if (!stamp)
+    return buffer.control.reserve.fetch_add(count, std::memory_order_acq_rel);
+
+  // the clock is read after the previous slots were taken, so a slot is
+  // never stamped before them
+  sequence_t ticket = buffer.control.reserve.load(std::memory_order_acquire);
+  typename B::backoff_t backoff;
+
+  for (;;) {
+    timestamp = B::clock_source_t::now();
+    if (buffer.control.reserve.compare_exchange_weak(
+            ticket, ticket + count, std::memory_order_acq_rel,
+            std::memory_order_acquire))
+      return ticket;
+    backoff.wait();
+  }
+}
+
+template <typename B>
+typename B::event_t &RTML_writer<B>::reserve(RTML_ticket) {
+
+  if (!attached)
+    return detached(buffer.UNSAFE);
+
+  timespan timestamp;
+  reserved = take(1, true, timestamp);
+
+  buffer.claim(reserved);
+  buffer.begin_write(B::index_t::slot(reserved));
+
+  typename B::event_t &slot =
+      reserved_slot(B::index_t::slot(reserved), typename B::storage());
+  slot.setTime(timestamp);
+
+  reserved_err = (reserved >= buffer.control.drop.load(
+                                  std::memory_order_acquire) +
+                                  buffer.size_util)
+                     ? buffer.BUFFER_OVERFLOW
+                     : buffer.OK;
+
+  return slot;
+}
+
+template <typename B> typename B::error_t RTML_writer<B>::commit(RTML_ticket) {
+
+  if (!committable())
+    return reserved_err;
+
+  size_t index = B::index_t::slot(reserved);
+
+  settle(index, typename B::storage());
+  buffer.slot_version.end_write(index);
+  buffer.control.publish(reserved);
+
+  notify(&reserved_slot(index, typename B::storage()), 1, reserved + 1,
+         typename B::notification());
+
+  return reserved_err;
+}
+
+template <typename B>
+typename B::error_t RTML_writer<B>::push(typename B::event_t &event,
+                                         bool stamp, RTML_single_producer) {
+
+  if (!attached)
+    return buffer.UNSAFE;
+
+  // only this writer moves the top, so it needs no read-modify-write
+  sequence_t top = buffer.control.top.load(std::memory_order_relaxed);
+
+  if (stamp) {
+    timespan timestamp = B::clock_source_t::now();
+    event.setTime(timestamp);
+  }
+
+  if (!buffer.fits(&event, 1, B::index_t::slot(top)))
+    return buffer.OUT_OF_BOUND;
+
+  buffer.write(event, B::index_t::slot(top));
+  buffer.mark(B::index_t::slot(top), top + 1);
+
+  buffer.control.top.store(top + 1, std::memory_order_release);
+
+  notify(&event, 1, top + 1, typename B::notification());
+
+  return (top >= buffer.control.drop.load(std::memory_order_acquire) +
+                     buffer.size_util)
+             ? buffer.BUFFER_OVERFLOW
+             : buffer.OK;
+}
+
+template <typename B>
+typename B::error_t
+RTML_writer<B>::push_n(typename B::event_t *events, size_t count,
+                       size_t &discarded, bool stamp, RTML_single_producer) {
+
+  discarded = 0;
+  if (!attached)
+    return buffer.UNSAFE;
+
+  if (count == 0)
+    return buffer.OK;
+
+  const size_t n = (count > buffer.size_util) ? buffer.size_util : count;
+  const size_t skip = count - n;
+
+  sequence_t top = buffer.control.top.load(std::memory_order_relaxed);
+
+  if (stamp) {
+    timespan timestamp = B::clock_source_t::now();
+    for (size_t i = skip; i < count; i++)
+      events[i].setTime(timestamp);
+  }
+
+  if (!buffer.fits(events + skip, n, B::index_t::slot(top + skip)))
+    return buffer.OUT_OF_BOUND;
+
+  buffer.write(events + skip, n, B::index_t::slot(top + skip));
+
+  for (size_t i = 0; i < n; i++)
+    buffer.mark(B::index_t::slot(top + skip + i), top + skip + i + 1);
+
+  // one release store publishes the whole burst
+  buffer.control.top.store(top + count, std::memory_order_release);
+
+  notify(events + skip, n, top + count, typename B::notification());
+
+  sequence_t d = buffer.control.drop.load(std::memory_order_acquire);
+  size_t len = (d > top) ? 0
+               : (top - d > buffer.size_util) ? buffer.size_util
+                                              : top - d;
+
+  discarded = (len + count > buffer.size_util)
+                  ? len + count - buffer.size_util
+                  : 0;
+
+  return (discarded > 0) ? buffer.BUFFER_OVERFLOW : buffer.OK;
+}
+
+template <typename B>
+typename B::event_t &RTML_writer<B>::reserve(RTML_single_producer) {
+
+  if (!attached)
+    return detached(buffer.UNSAFE);
+
+  reserved = buffer.control.top.load(std::memory_order_relaxed);
+
+  timespan timestamp = B::clock_source_t::now();
+
+  typename B::event_t event;
+  event.setTime(timestamp);
+  if (!buffer.fits(&event, 1, B::index_t::slot(reserved)))
+    return detached(buffer.OUT_OF_BOUND);
+
+  stamped = timestamp;
+
+  buffer.begin_write(B::index_t::slot(reserved));
+
+  typename B::event_t &slot =
+      reserved_slot(B::index_t::slot(reserved), typename B::storage());
+  slot.setTime(timestamp);
+
+  reserved_err = (reserved >= buffer.control.drop.load(
+                                  std::memory_order_acquire) +
+                                  buffer.size_util)
+                     ? buffer.BUFFER_OVERFLOW
+                     : buffer.OK;
+
+  return slot;
+}
+
+template <typename B>
+typename B::error_t RTML_writer<B>::commit(RTML_single_producer) {
+
+  if (!committable())
+    return reserved_err;
+
+  size_t index = B::index_t::slot(reserved);
+
+  settle(index, typename B::storage());
+  buffer.slot_version.end_write(index);
+  buffer.mark(index, reserved + 1);
+
+  buffer.control.top.store(reserved + 1, std::memory_order_release);
+
+  notify(&reserved_slot(index, typename B::storage()), 1, reserved + 1,
+         typename B::notification());
+
+  return reserved_err;
+}
+
+#endif
+
 #endif //_RTEML_WRITER_H_
@@ -0,0 +1,99 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib buffer layout with the cache aligned policy
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct ticket_aligned_policy : RTML_cache_aligned_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+#define LINE RTML_CACHE_LINE_SIZE
+
+#define ALIGNED(x) ((uintptr_t)(x) % LINE == 0)
+
+template <typename B> void aligned_push_and_pull() {
+  static B buf;
+
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+  RTML_reader<B> reader = RTML_reader<B>(buf);
+
+  // the slot array and the control block start at their own cache lines
+  assert(ALIGNED(&buf.slot(0)));
+  assert(ALIGNED(&buf.control));
+
+  Event<int> e;
+  for (int i = 0; i < 10; i++) {
+    e.set(i, i);
+    assert(writer.push_all(e) == buf.OK);
+  }
+
+  reader.synchronize();
+
+  for (int i = 0; i < 9; i++) {
+    assert(reader.pull(e) == reader.AVAILABLE);
+    assert(e.getTime() == i && e.getData() == i);
+  }
+
+  for (int i = 0; i < 10; i++)
+    assert(buf.pull(e) == buf.OK && e.getTime() == i);
+}
+
+extern "C" int rtmlib_buffer_layout();
+
+int rtmlib_buffer_layout() {
+
+  typedef RTML_buffer<Event<int>, 100> packed_t;
+  typedef RTML_buffer<Event<int>, 100, RTML_cache_aligned_policy> aligned_t;
+  typedef RTML_buffer<Event<int>, 100, ticket_aligned_policy> ticket_t;
+
+  // the default policy keeps the natural layout
+  static_assert(alignof(packed_t) < LINE, "default layout is not packed");
+
+#ifndef __HW__
+  // each writer state fills whole cache lines
+  static_assert(alignof(aligned_t::state_t) == LINE, "state not aligned");
+  static_assert(sizeof(aligned_t::state_t) % LINE == 0, "state not padded");
+
+  static aligned_t buf;
+  assert(ALIGNED(&buf.page) && ALIGNED(&buf.state_global));
+
+  // the counters of the ticket protocol do not share cache lines
+  static ticket_t tbuf;
+  assert(ALIGNED(&tbuf.control.reserve) && ALIGNED(&tbuf.control.commit) &&
+         ALIGNED(&tbuf.control.drop) && ALIGNED(&tbuf.control.seq[0]));
+#endif
+
+  aligned_push_and_pull<aligned_t>();
+
+  aligned_push_and_pull<ticket_t>();
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib writers timestamping events with the clock sources
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <writer.h>
+
+namespace clocks {
+
+// a counter that the test sets, e.g., to go backwards
+unsigned ticks = 0;
+
+unsigned tick() { return ticks; }
+
+} // namespace clocks
+
+struct tick_policy : RTML_buffer_policy {
+  typedef RTML_tick_clock<unsigned, clocks::tick, 1000> clock_source;
+};
+
+struct ticket_tick_policy : tick_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+struct single_producer_tick_policy : tick_policy {
+  typedef RTML_single_producer writer_protocol;
+};
+
+struct coarse_policy : RTML_buffer_policy {
+  typedef RTML_coarse_clock clock_source;
+};
+
+struct tsc_policy : RTML_buffer_policy {
+  typedef RTML_tsc_clock<> clock_source;
+};
+
+namespace clocks {
+
+// every protocol stamps events with the ticks of the counter
+template <typename B> void ticks_of_counter() {
+  static B buf;
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+
+  Event<int> e, events[2];
+
+  ticks = 3;
+  writer.push(e);
+  ticks = 5;
+  writer.push_n(events, 2);
+  ticks = 7;
+  writer.reserve();
+  writer.commit();
+
+  const timespan expected[] = {3000, 5000, 5000, 7000};
+  for (int i = 0; i < 4; i++) {
+    assert(buf.pull(e) == buf.OK);
+    assert(e.getTime() == expected[i]);
+  }
+}
+
+// page swap writers never stamp an event older than the last pushed one
+void page_swap_monotonic() {
+  static RTML_buffer<Event<int>, 100, tick_policy> buf;
+  RTML_writer<RTML_buffer<Event<int>, 100, tick_policy>> writer =
+      RTML_writer<RTML_buffer<Event<int>, 100, tick_policy>>(buf);
+
+  Event<int> e, events[2];
+
+  ticks = 10;
+  writer.push(e);
+  ticks = 4;
+  writer.push(e);
+  writer.push_n(events, 2);
+  writer.reserve();
+  writer.commit();
+
+  for (int i = 0; i < 5; i++) {
+    assert(buf.pull(e) == buf.OK);
+    assert(e.getTime() == 10000);
+  }
+}
+
+// the clock follows CLOCK_MONOTONIC within the given error and never goes
+// backwards
+template <typename C> void follows_monotonic(timespan error) {
+  timespan last = C::now();
+
+  for (int i = 0; i < 1000; i++) {
+    struct timespec n;
+    clock_gettime(CLOCK_MONOTONIC, &n);
+    timespan monotonic = (timespan)n.tv_sec * 1000000000 + n.tv_nsec;
+
+    timespan t = C::now();
+    assert(t >= last);
+    assert(t - monotonic < error && monotonic - t < error);
+    last = t;
+  }
+}
+
+} // namespace clocks
+
+extern "C" int rtmlib_clock_source();
+
+int rtmlib_clock_source() {
+
+  clocks::ticks_of_counter<RTML_buffer<Event<int>, 100, tick_policy>>();
+  clocks::ticks_of_counter<
+      RTML_buffer<Event<int>, 100, ticket_tick_policy>>();
+  clocks::ticks_of_counter<
+      RTML_buffer<Event<int>, 100, single_producer_tick_policy>>();
+
+  clocks::page_swap_monotonic();
+
+  // the coarse clock lags by a few kernel ticks (tickless kernels skip them)
+  struct timespec res;
+  clock_getres(CLOCK_MONOTONIC_COARSE, &res);
+  clocks::follows_monotonic<RTML_coarse_clock>(10 * res.tv_nsec);
+
+  // the counter reads CLOCK_MONOTONIC until it is calibrated
+  assert(RTML_tsc_clock<>::calibrated.scale == 0);
+  clocks::follows_monotonic<RTML_tsc_clock<>>(1000000);
+
+  // the calibrated counter drifts by less than a millisecond
+  RTML_tsc_clock<>::calibrate();
+  assert(RTML_tsc_clock<>::calibrated.scale != 0);
+  clocks::follows_monotonic<RTML_tsc_clock<>>(1000000);
+
+  // and stamps the pushed events
+  static RTML_buffer<Event<int>, 100, tsc_policy> buf;
+  RTML_writer<RTML_buffer<Event<int>, 100, tsc_policy>> writer =
+      RTML_writer<RTML_buffer<Event<int>, 100, tsc_policy>>(buf);
+  Event<int> e;
+  timespan before = RTML_tsc_clock<>::now();
+  writer.push(e);
+  assert(buf.pull(e) == buf.OK);
+  assert(e.getTime() >= before && e.getTime() <= RTML_tsc_clock<>::now());
+
+  // and the coarse clock too
+  static RTML_buffer<Event<int>, 100, coarse_policy> coarse_buf;
+  RTML_writer<RTML_buffer<Event<int>, 100, coarse_policy>> coarse_writer =
+      RTML_writer<RTML_buffer<Event<int>, 100, coarse_policy>>(coarse_buf);
+  before = RTML_coarse_clock::now();
+  coarse_writer.push(e);
+  assert(coarse_buf.pull(e) == coarse_buf.OK);
+  assert(e.getTime() >= before && e.getTime() <= RTML_coarse_clock::now());
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,218 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib buffer keeping timestamps as deltas against a base per block
+ */
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+namespace delta {
+
+// the time that reserve stamps slots with; it must fit the deltas too
+timespan now = 0;
+
+} // namespace delta
+
+struct delta_clock {
+  static timespan now() { return delta::now; }
+};
+
+struct delta_policy : RTML_buffer_policy {
+  typedef RTML_delta_storage<uint16_t, 16> storage;
+  typedef delta_clock clock_source;
+};
+
+struct single_producer_delta_policy : delta_policy {
+  typedef RTML_single_producer writer_protocol;
+};
+
+namespace delta {
+
+// timestamps beyond 32 bits, 1000 time units apart, so the 16-bit deltas
+// wrap every 66 events
+const timespan origin = 5000000000L;
+const timespan step = 1000;
+
+template <typename B> void laps() {
+  static B buf;
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+  RTML_reader<B> reader = RTML_reader<B>(buf);
+
+  Event<uint8_t> e;
+
+  // three laps of the ring through push, push_n and reserve
+  int i = 0;
+  while (i < 300) {
+    uint8_t d = i;
+    e.set(d, origin + i * step);
+    writer.push_all(e);
+    i++;
+
+    Event<uint8_t> burst[3];
+    for (int j = 0; j < 3; j++, i++) {
+      d = i;
+      burst[j].set(d, origin + i * step);
+    }
+    writer.push_all_n(burst, 3);
+
+    timespan t = origin + i * step;
+    now = t;
+    Event<uint8_t> &slot = writer.reserve();
+    d = i;
+    slot.set(d, t);
+    writer.commit();
+    i++;
+  }
+
+  // the last 100 events keep their full timestamps
+  reader.synchronize();
+  Event<uint8_t> events[99];
+  size_t n;
+  assert(reader.pull_n(events, 99, n) == reader.AVAILABLE && n == 99);
+  for (int j = 0; j < 99; j++) {
+    assert(events[j].getData() == (uint8_t)(200 + j));
+    assert(events[j].getTime() == origin + (200 + j) * step);
+  }
+
+  size_t b, t;
+  timespanw ts, ts_t;
+  buf.state(b, t, ts, ts_t);
+  assert(ts == origin + 200 * step);
+}
+
+// events further than 2^15 time units from the base of their block are
+// rejected before they are published, and the next events still fit
+template <typename B> void gaps() {
+  static B buf;
+  RTML_writer<B> writer(buf);
+
+  Event<uint8_t> e, burst[2];
+  uint8_t d = 1;
+
+  e.set(d, 1000);
+  assert(writer.push_all(e) == buf.OK);
+  e.set(d, 2000);
+  assert(writer.push_all(e) == buf.OK);
+  e.set(d, 50000);
+  assert(writer.push_all(e) == buf.OUT_OF_BOUND);
+  e.set(d, 100000);
+  assert(writer.push_all(e) == buf.OUT_OF_BOUND);
+
+  burst[0].set(d, 3000);
+  burst[1].set(d, 60000);
+  assert(writer.push_all_n(burst, 2) == buf.OUT_OF_BOUND);
+
+  // so is a slot reserved with a clock that does not fit
+  now = 40000;
+  writer.reserve();
+  assert(writer.commit() == buf.OUT_OF_BOUND);
+
+  // a reserved slot keeps its timestamp if the one set does not fit
+  now = 4000;
+  Event<uint8_t> &slot = writer.reserve();
+  d = 2;
+  slot.set(d, 60000);
+  assert(writer.commit() == buf.OUT_OF_BOUND);
+
+  d = 3;
+  e.set(d, 5000);
+  assert(writer.push_all(e) == buf.OK);
+
+  // the first slot of the next block sets a new base
+  for (timespan t = 5001; t < 5013; t++) {
+    e.set(d, t);
+    assert(writer.push_all(e) == buf.OK);
+  }
+  e.set(d, 1000000);
+  assert(writer.push_all(e) == buf.OK);
+  e.set(d, 1000100);
+  assert(writer.push_all(e) == buf.OK);
+
+  Event<uint8_t> events[18];
+  assert(buf.read(events, 18, 0) == buf.OK);
+  assert(events[0].getTime() == 1000 && events[1].getTime() == 2000);
+  assert(events[2].getData() == 2 && events[2].getTime() == 4000);
+  assert(events[3].getTime() == 5000);
+  for (int j = 4; j < 16; j++)
+    assert(events[j].getTime() == 5001 + j - 4);
+  assert(events[16].getTime() == 1000000);
+  assert(events[17].getTime() == 1000100);
+}
+
+} // namespace delta
+
+extern "C" int rtmlib_delta_storage();
+
+int rtmlib_delta_storage() {
+
+  typedef RTML_slot_storage<Event<uint8_t>, 128, RTML_event_storage> events_t;
+  typedef RTML_slot_storage<Event<uint8_t>, 128,
+                            RTML_delta_storage<uint16_t, 64>>
+      deltas_t;
+
+  // a slot takes 4 bytes instead of 16 on 64-bit targets
+  static_assert(sizeof(deltas_t::slot_t) == 4, "delta slot is not packed");
+  static_assert(sizeof(events_t) >= 3 * sizeof(deltas_t) ||
+                    sizeof(timespan) < 8,
+                "delta storage is not compact");
+
+  static deltas_t storage;
+  Event<uint8_t> e;
+  uint8_t d = 1;
+
+  // timestamps before the base of their block are rebuilt too
+  e.set(d, delta::origin);
+  storage.put(0, e);
+  e.set(d, delta::origin - 5);
+  storage.put(1, e);
+  e.set(d, delta::origin + 30000);
+  storage.put(2, e);
+  assert(storage.time(0) == delta::origin);
+  assert(storage.time(1) == delta::origin - 5);
+  assert(storage.time(2) == delta::origin + 30000);
+
+  // the next lap of the block keeps the base of the events not overwritten
+  e.set(d, delta::origin + 100000);
+  storage.put(0, e);
+  e.set(d, delta::origin + 100010);
+  storage.put(1, e);
+  assert(storage.time(0) == delta::origin + 100000);
+  assert(storage.time(1) == delta::origin + 100010);
+  assert(storage.time(2) == delta::origin + 30000);
+
+  delta::laps<RTML_buffer<Event<uint8_t>, 100, delta_policy>>();
+  delta::laps<
+      RTML_buffer<Event<uint8_t>, 100, single_producer_delta_policy>>();
+
+  delta::gaps<RTML_buffer<Event<uint8_t>, 100, delta_policy>>();
+  delta::gaps<
+      RTML_buffer<Event<uint8_t>, 100, single_producer_delta_policy>>();
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
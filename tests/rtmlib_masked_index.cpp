@@ -0,0 +1,111 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib buffer with the masked index mode
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/reader.h>
+#include <writer.h>
+
+struct masked_policy : RTML_buffer_policy {
+  typedef RTML_masked_index index_mode;
+};
+
+struct ticket_masked_policy : masked_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+template <typename B> void masked_reader_and_writer() {
+  static B buf;
+
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+  RMTLD3_reader<RTML_reader<B>> reader = RMTLD3_reader<RTML_reader<B>>(buf);
+
+  // overload the buffer so that the indices wrap around twice
+  Event<int> e;
+  for (int i = 0; i < 40; i++) {
+    e.set(i, i);
+    writer.push_all(e);
+  }
+  assert(buf.length() == buf.size_util);
+
+  reader.synchronize();
+  reader.reset();
+  assert(reader.length() == buf.size_util);
+
+  // the cursor is positioned across the wrap of the ring
+  timespan t = 35;
+  assert(reader.set(t) == reader.AVAILABLE);
+  assert(reader.read(e) == reader.AVAILABLE && e.getTime() == 35);
+
+  // moving backwards stops at the event that follows t
+  t = 26;
+  assert(reader.set(t) == reader.AVAILABLE);
+  assert(reader.read_previous(e) == reader.AVAILABLE && e.getTime() == 26);
+
+  reader.reset();
+
+  Event<int> events[16];
+  size_t n;
+  assert(reader.pull_n(events, 16, n) == reader.UNAVAILABLE && n == 15);
+  for (size_t i = 0; i < n; i++)
+    assert(events[i].getTime() == 25 + (timespan)i);
+
+  // pull the events of the buffer itself
+  for (int i = 25; i < 40; i++)
+    assert(buf.pull(e) != buf.EMPTY && e.getTime() == i);
+  assert(buf.pull(e) == buf.EMPTY);
+}
+
+extern "C" int rtmlib_masked_index();
+
+int rtmlib_masked_index() {
+
+  typedef RTML_index<8, RTML_wrapped_index> wrapped_t;
+  typedef RTML_index<8, RTML_masked_index> masked_t;
+
+  // both index modes agree on every index of the ring
+  for (size_t i = 0; i < 8; i++) {
+    assert(masked_t::next(i) == wrapped_t::next(i));
+    assert(masked_t::prev(i) == wrapped_t::prev(i));
+    assert(masked_t::slot(i + 24) == wrapped_t::slot(i + 24));
+
+    for (size_t j = 0; j < 8; j++) {
+      assert(masked_t::advance(i, j) == wrapped_t::advance(i, j));
+      assert(masked_t::retreat(i, j) == wrapped_t::retreat(i, j));
+      assert(masked_t::distance(i, j) == wrapped_t::distance(i, j));
+    }
+  }
+
+  masked_reader_and_writer<RTML_buffer<Event<int>, 15, masked_policy>>();
+
+  masked_reader_and_writer<
+      RTML_buffer<Event<int>, 15, ticket_masked_policy>>();
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
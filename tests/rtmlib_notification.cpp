@@ -0,0 +1,231 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib readers and monitors woken by writer notifications
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct wakeup_policy : RTML_buffer_policy {
+  typedef RTML_wakeup_notification notification;
+
+  static const size_t watermark = 4;
+
+  // the proposition 99 is reported at once
+  template <typename E> static bool urgent(const E &e) {
+    return e.getData() == 99;
+  }
+};
+
+struct ticket_wakeup_policy : wakeup_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+struct single_producer_wakeup_policy : wakeup_policy {
+  typedef RTML_single_producer writer_protocol;
+};
+
+#ifndef NO_THREADS
+
+#include <periodicmonitor.h>
+#include <task_compat.h>
+
+namespace wakeup {
+
+const long second = 1000000000L;
+
+struct timespec after(long ns) {
+  struct timespec t;
+  clock_gettime(CLOCK_REALTIME, &t);
+  t.tv_sec += (t.tv_nsec + ns) / second;
+  t.tv_nsec = (t.tv_nsec + ns) % second;
+  return t;
+}
+
+long elapsed(const struct timespec &start) {
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+  return (now.tv_sec - start.tv_sec) * second + now.tv_nsec - start.tv_nsec;
+}
+
+typedef RTML_buffer<Event<int>, 100, wakeup_policy> buffer_t;
+
+buffer_t buf;
+
+// the last page written refers to the writer state, so it outlives the thread
+void *producer(void *) {
+  static RTML_writer<buffer_t> writer = RTML_writer<buffer_t>(buf);
+
+  nanosleep((const struct timespec[]){{0, 50000000L}}, NULL);
+
+  for (int i = 0; i < 4; i++) {
+    Event<int> e = Event<int>(i, 0);
+    writer.push(e);
+  }
+
+  return NULL;
+}
+
+// a blocked reader wakes once the watermark is crossed, long before its
+// deadline
+void reader() {
+  RTML_reader<buffer_t> reader = RTML_reader<buffer_t>(buf);
+  pthread_t thread;
+
+  struct timespec start, deadline = after(10 * second);
+  clock_gettime(CLOCK_REALTIME, &start);
+
+  assert(!pthread_create(&thread, NULL, producer, NULL));
+
+  assert(reader.wait(&deadline));
+  assert(elapsed(start) < 5 * second);
+
+  assert(!pthread_join(thread, NULL));
+  assert(buf.length() == 4);
+}
+
+typedef RTML_buffer<Event<int>, 100, wakeup_policy> monitor_buffer_t;
+
+monitor_buffer_t monitor_buf;
+
+class M_wakeup : public RTML_monitor<'n', 't', 'f', 'y'> {
+public:
+  std::atomic<int> runs;
+
+  M_wakeup(useconds_t period) : RTML_monitor(period), runs(0) {}
+
+protected:
+  void run() { runs++; }
+};
+
+// the monitor runs on an urgent event instead of at its period (10s)
+void monitor() {
+  static M_wakeup mon(10000000);
+  RTML_writer<monitor_buffer_t> writer =
+      RTML_writer<monitor_buffer_t>(monitor_buf);
+
+  mon.wakeup(monitor_buf);
+  mon.enable();
+
+  nanosleep((const struct timespec[]){{0, 10000000L}}, NULL);
+
+  struct timespec start;
+  clock_gettime(CLOCK_REALTIME, &start);
+
+  int d = 99;
+  Event<int> e = Event<int>(d, 0);
+  writer.push(e);
+
+  while (mon.runs.load() == 0 && elapsed(start) < 5 * second)
+    sched_yield();
+
+  assert(mon.runs.load() > 0);
+
+  // wake the monitor once more to let it see that it is disabled
+  mon.disable();
+  writer.push(e);
+  assert(!mon.join());
+}
+
+} // namespace wakeup
+
+#endif
+
+#ifndef NO_THREADS
+
+template <typename B> void notification() {
+  static B buf;
+
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+  RTML_reader<B> reader = RTML_reader<B>(buf);
+
+  // a deadline in the past
+  struct timespec past = {0, 0};
+
+  Event<int> e;
+  Event<int> events[8];
+
+  // the readers are notified once every 4 events
+  for (int i = 0; i < 3; i++) {
+    e = Event<int>(i, 0);
+    writer.push(e);
+  }
+  assert(buf.notifier.seq.load() == 0);
+  assert(!reader.wait(&past));
+
+  e = Event<int>(3, 0);
+  writer.push(e);
+  assert(buf.notifier.seq.load() == 1);
+
+  // and at once for urgent events
+  int d = 99;
+  e.setData(d);
+  writer.push(e);
+  assert(buf.notifier.seq.load() == 2);
+
+  // a burst crossing the watermark twice notifies once
+  writer.push_n(events, 8);
+  assert(buf.notifier.seq.load() == 3);
+
+  Event<int> &slot = writer.reserve();
+  slot.setData(d);
+  writer.commit();
+  assert(buf.notifier.seq.load() == 4);
+
+  // a reader returns at once for notifications it has not seen
+  assert(reader.wait(&past));
+  assert(!reader.wait(&past));
+}
+
+#endif
+
+extern "C" int rtmlib_notification();
+
+int rtmlib_notification() {
+
+#ifndef NO_THREADS
+  notification<RTML_buffer<Event<int>, 100, wakeup_policy>>();
+  notification<RTML_buffer<Event<int>, 100, ticket_wakeup_policy>>();
+  notification<
+      RTML_buffer<Event<int>, 100, single_producer_wakeup_policy>>();
+#endif
+
+  // without notifications readers never block
+  static RTML_buffer<Event<int>, 100> buf;
+  RTML_reader<RTML_buffer<Event<int>, 100>> reader =
+      RTML_reader<RTML_buffer<Event<int>, 100>>(buf);
+  struct timespec never = {0x7fffffff, 0};
+  assert(!reader.wait(&never));
+
+#ifndef NO_THREADS
+  wakeup::reader();
+  wakeup::monitor();
+#endif
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib generated formulas checked offline at each event of a trace file
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/horizon.h>
+#include <rmtld3/offline.h>
+#include <rmtld3/reader.h>
+
+#include "custom-rtm-monitor/Rtm_compute_6ea3.h"
+
+typedef Event<proposition> event_t;
+typedef RMTLD3_offline<event_t> offline_t;
+
+// the trace in one buffer
+typedef RTML_buffer<event_t, 2000> reference_t;
+typedef RMTLD3_reader<RTML_reader<reference_t>> reference_trace_t;
+
+namespace offline {
+
+const int events = 1500;
+
+// pairs of events share their timestamp
+event_t event(int i) {
+  proposition p = (i % 11 == 10) ? PROP_b : (i % 13 == 0) ? PROP_c : PROP_a;
+  return event_t(p, 3 * (i / 2) + 1);
+}
+
+// the verdicts of the generated monitor at the timestamp of each event
+std::vector<three_valued_type> expected() {
+  static reference_t buf;
+  std::vector<three_valued_type> verdicts;
+
+  for (int i = 0; i < events; i++) {
+    event_t e = event(i);
+    buf.push(e);
+  }
+
+  reference_trace_t trace(buf);
+  trace.synchronize();
+
+  for (int i = 0; i < events; i++) {
+    timespan t = event(i).getTime();
+    trace.set(t);
+    verdicts.push_back(_rtm_compute_6ea3_0<reference_trace_t>(trace, t));
+  }
+
+  return verdicts;
+}
+
+// the generated formula, a U[9.] b or not (not c or not not c)
+typedef op_h<until_less_h<prop_h, prop_h, 9>, op_h<prop_h>> compute_h;
+
+// the runs cover the events from first to last with the expected verdicts
+void check(const offline_t &checker, size_t first, size_t last,
+           const std::vector<three_valued_type> &verdicts,
+           unsigned threads = 1,
+           timespan horizon = RMTLD3_horizon<compute_h>::future) {
+  std::vector<RMTLD3_verdict> runs;
+
+  size_t evaluations = checker.check(
+      _rtm_compute_6ea3_0<offline_t::trace_t>, first, last,
+      [&runs](const RMTLD3_verdict &v) { runs.push_back(v); }, threads,
+      horizon);
+
+  assert(evaluations == (last - 1) / 2 - first / 2 + 1);
+  assert(!runs.empty() && runs.front().first == first &&
+         runs.back().last == last - 1);
+
+  for (size_t r = 0; r < runs.size(); r++) {
+    const RMTLD3_verdict &v = runs[r];
+
+    assert(r == 0 || (v.first == runs[r - 1].last + 1 &&
+                      v.value != runs[r - 1].value));
+    assert(v.from == event(v.first).getTime() &&
+           v.to == event(v.last).getTime());
+
+    for (size_t i = v.first; i <= v.last; i++)
+      assert(verdicts[i] == v.value);
+  }
+}
+
+} // namespace offline
+
+extern "C" int rtmlib_offline_check();
+
+int rtmlib_offline_check() {
+
+  char path[] = "/tmp/rtmlib_offline_XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  close(fd);
+
+  RTML_trace_recorder<event_t, 256> recorder;
+  assert(recorder.create(path) == recorder.OK);
+  for (int i = 0; i < offline::events; i++) {
+    event_t e = offline::event(i);
+    assert(recorder.append(&e, 1) == recorder.OK);
+  }
+  assert(recorder.close() == recorder.OK);
+
+  static RTML_trace_buffer<event_t> trace;
+  assert(trace.open(path) == trace.OPENED);
+
+  std::vector<three_valued_type> verdicts = offline::expected();
+
+  // the formula has all verdicts along the trace
+  size_t count[3] = {0, 0, 0};
+  for (size_t i = 0; i < verdicts.size(); i++)
+    count[verdicts[i] == T_TRUE ? 0 : (verdicts[i] == T_FALSE ? 1 : 2)]++;
+  assert(count[0] > 0 && count[1] > 0 && count[2] > 0);
+
+  // blocks smaller than the trace drop the pages behind them
+  offline::check(offline_t(trace), 0, offline::events, verdicts);
+  offline::check(offline_t(trace, 100), 0, offline::events, verdicts);
+  offline::check(offline_t(trace, 100), 251, 1203, verdicts);
+
+#ifndef NO_THREADS
+  // chunks of an odd number of events split the events of a timestamp
+  offline::check(offline_t(trace, 100), 0, offline::events, verdicts, 4);
+  offline::check(offline_t(trace, 37), 0, offline::events, verdicts, 4);
+  offline::check(offline_t(trace, 37), 251, 1203, verdicts, 3);
+  offline::check(offline_t(trace, 1), 0, 100, verdicts, 8);
+
+  // the horizon only sets the prefetch, up to the end of the trace
+  offline::check(offline_t(trace, 100), 0, offline::events, verdicts, 4,
+                 RMTLD3_HORIZON_UNBOUNDED);
+  offline::check(offline_t(trace, 100), 0, offline::events, verdicts, 4, 0);
+#endif
+
+  trace.close();
+  unlink(path);
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib reader batch pull
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/reader.h>
+
+extern "C" int rtmlib_reader_pull_n();
+
+int rtmlib_reader_pull_n() {
+
+  typedef RTML_buffer<Event<int>, 100> buffer_t;
+
+  static buffer_t buf;
+  int ID = 0x01;
+
+  RTML_reader<buffer_t> reader = RTML_reader<buffer_t>(buf);
+
+  Event<int> events[100];
+  size_t n;
+
+  assert(reader.pull_n(events, 40, n) == reader.UNAVAILABLE && n == 0);
+
+  // fill the buffer so that the live window wraps around the end
+  Event<int> nodex = Event<int>();
+  for (long int i = 0; i < 150; i++) {
+    nodex.set(ID, i);
+    buf.push(nodex);
+  }
+
+  assert(reader.synchronize() == reader.GAP);
+  assert(reader.length() == buf.size_util);
+
+  // drain in batches of 40; the last event is kept for gap detection
+  long int expected = 50;
+  size_t total = 0;
+  while (reader.pull_n(events, 40, n) == reader.AVAILABLE) {
+    for (size_t i = 0; i < n; i++)
+      assert(events[i].getTime() == expected++);
+    total += n;
+  }
+
+  assert(total == buf.size_util - 1 && n == 0);
+  assert(reader.length() == 1);
+
+  // a lagging reader resynchronizes and pulls the new window
+  for (long int i = 150; i < 300; i++) {
+    nodex.set(ID, i);
+    buf.push(nodex);
+  }
+
+  assert(reader.synchronize() == reader.GAP);
+  assert(reader.pull_n(events, 100, n) == reader.AVAILABLE && n == 99);
+  assert(events[0].getTime() == 200 && events[98].getTime() == 298);
+
+  // the cursor of the rmtld3 reader advances over the batch
+  typedef RMTLD3_reader<RTML_reader<buffer_t>, int> trace_t;
+  int lmem = 0;
+  trace_t trace = trace_t(buf, lmem);
+
+  trace.synchronize();
+  trace.reset();
+
+  assert(trace.pull_n(events, 30, n) == trace.AVAILABLE && n == 30);
+  assert(events[0].getTime() == 200 && events[29].getTime() == 229);
+  assert(trace.consumed() == 30);
+
+  Event<int> e;
+  assert(trace.read(e) == trace.AVAILABLE && e.getTime() == 230);
+
+  assert(trace.pull_n(events, 100, n) == trace.UNAVAILABLE && n == 70);
+  assert(events[69].getTime() == 299);
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,228 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rmtlib_rmtld3 horizon of formulas and the buffers that hold it
+ */
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/formulas.h>
+#include <rmtld3/horizon.h>
+#include <rmtld3/reader.h>
+
+// a U[9] b nested in U[10] c
+typedef until_less_h<until_less_h<prop_h, prop_h, 9>, prop_h, 10> nested_h;
+
+// (a S[8] b) or eventually[=5] c
+typedef op_h<since_less_h<prop_h, prop_h, 8>, eventually_equal_h<prop_h, 5>>
+    mixed_h;
+
+static_assert(RMTLD3_horizon<prop_h>::future == 0 &&
+                  RMTLD3_horizon<prop_h>::past == 0,
+              "propositions are read at the time of the evaluation");
+static_assert(RMTLD3_horizon<nested_h>::future == 19 &&
+                  RMTLD3_horizon<nested_h>::past == 0,
+              "nested bounds are added");
+static_assert(RMTLD3_horizon<mixed_h>::future == 5 &&
+                  RMTLD3_horizon<mixed_h>::past == 8,
+              "connectives take the largest bounds");
+static_assert(
+    RMTLD3_horizon<always_less_h<historically_less_h<prop_h, 3>, 4>>::future ==
+            4 &&
+        RMTLD3_horizon<
+            always_less_h<historically_less_h<prop_h, 3>, 4>>::past == 3,
+    "past and future bounds are kept apart");
+static_assert(
+    RMTLD3_horizon<op_h<duration_term_h<prop_h, 7>,
+                        pasteventually_equal_h<prop_h, 2>>>::future == 7,
+    "terms read up to their bound");
+static_assert(RMTLD3_horizon<eventually_less_unbounded_h<
+                      until_less_h<prop_h, prop_h, 1>>>::future ==
+                  RMTLD3_HORIZON_UNBOUNDED,
+              "unbounded formulas have an unbounded horizon");
+
+// a S[4] b nested in U[6] c, evaluated from its horizon type
+typedef until_less_h<since_less_h<atom_h<1>, atom_h<2>, 4>, atom_h<3>, 6>
+    retained_h;
+
+static_assert(RMTLD3_horizon<retained_h>::future == 6 &&
+                  RMTLD3_horizon<retained_h>::past == 4,
+              "formulas evaluated from their horizon type have its horizon");
+
+// a buffer of 100 events holds the nested formula at an event per time unit
+static_assert(RMTLD3_horizon<nested_h>::events(1) <= 100, "");
+static_assert(RMTLD3_horizon<nested_h>::events(0) ==
+                  std::numeric_limits<size_t>::max(),
+              "events without a minimum inter-arrival time are unbounded");
+
+template <typename T> class Eval_ab {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    return prop<T>(trace, 1, t);
+  };
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    return prop<T>(trace, 2, t);
+  };
+};
+
+template <typename T> class Eval_nested {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    return until_less<T, Eval_ab<T>, 9>(trace, t);
+  };
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    return prop<T>(trace, 3, t);
+  };
+};
+
+template <typename T> class Eval_mixed {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    return prop<T>(trace, 3, t);
+  };
+};
+
+namespace horizon {
+
+template <typename T> struct nested_f {
+  static three_valued_type compute(T &trace, timespan &t) {
+    return until_less<T, Eval_nested<T>, 10>(trace, t);
+  }
+};
+
+template <typename T> struct mixed_f {
+  static three_valued_type compute(T &trace, timespan &t) {
+    three_valued_type since = since_less<T, Eval_ab<T>, 8>(trace, t);
+    three_valued_type eventually =
+        eventually_equal<T, Eval_mixed<T>, 5>(trace, t);
+    return b3_or(since, eventually);
+  }
+};
+
+const int events = 200;
+
+// an event every 2 time units
+const timespan arrival = 2;
+
+Event<int> event(int i) { return Event<int>(i % 7 % 3 + 1, arrival * i + 1); }
+
+/*
+ * The formula evaluated with the events of its horizon only, in a buffer of
+ * the size the horizon requires, is the formula evaluated with the whole
+ * trace
+ */
+template <typename H, template <typename> class F> void holds() {
+  const size_t size = RMTLD3_horizon<H>::events(arrival);
+
+  typedef RTML_buffer<Event<int>, events> whole_t;
+  typedef RTML_buffer<Event<int>, size> window_t;
+  typedef RMTLD3_reader<RTML_reader<whole_t>> whole_trace_t;
+  typedef RMTLD3_reader<RTML_reader<window_t>> window_trace_t;
+
+  static whole_t whole;
+  for (int i = 0; i < events; i++) {
+    Event<int> e = event(i);
+    whole.push(e);
+  }
+  whole_trace_t reference(whole);
+  reference.synchronize();
+
+  const timespan past = RMTLD3_horizon<H>::past;
+  const timespan future = RMTLD3_horizon<H>::future;
+
+  for (timespan t = past + 1; t + future + 2 * arrival < arrival * events;
+       t++) {
+    // the event that holds the time the horizon starts at, and the next ones
+    window_t window;
+    size_t first = (t - past - 1) / arrival;
+    for (size_t i = first; i < first + size; i++) {
+      Event<int> e = event(i);
+      window.push(e);
+    }
+    window_trace_t trace(window);
+    trace.synchronize();
+
+    timespan tt = t, ttt = t;
+    trace.set(tt);
+    reference.set(ttt);
+    assert(F<window_trace_t>::compute(trace, tt) ==
+           F<whole_trace_t>::compute(reference, ttt));
+  }
+}
+
+/*
+ * The formula evaluated from its horizon type by a monitor that releases
+ * the events behind the horizon after each evaluation keeps the event that
+ * holds the start of the horizon, and is the formula evaluated with the
+ * whole trace
+ */
+template <typename H> void retained() {
+  typedef RTML_buffer<Event<int>, events> buffer_t;
+  typedef RMTLD3_reader<RTML_reader<buffer_t>> trace_t;
+
+  static buffer_t live, whole;
+  for (int i = 0; i < events; i++) {
+    Event<int> e = event(i);
+    live.push(e);
+    whole.push(e);
+  }
+
+  trace_t trace(live), reference(whole);
+  trace.synchronize();
+  reference.synchronize();
+
+  const timespan past = RMTLD3_horizon<H>::past;
+  const timespan future = RMTLD3_horizon<H>::future;
+  size_t released = 0;
+
+  for (timespan t = past + 1; t + future + 2 * arrival < arrival * events;
+       t++) {
+    timespan tt = t, ttt = t;
+    trace.set(tt);
+    reference.set(ttt);
+    assert(RMTLD3_formula<H>::eval(trace, tt) ==
+           RMTLD3_formula<H>::eval(reference, ttt));
+
+    released += trace.template retain<H>(t);
+
+    timespan first;
+    trace.reset();
+    assert(trace.read_time(first) == trace.AVAILABLE && first <= t - past);
+  }
+
+  assert(released > 0);
+}
+
+} // namespace horizon
+
+extern "C" int rtmlib_rmtld3_horizon();
+
+int rtmlib_rmtld3_horizon() {
+
+  horizon::holds<nested_h, horizon::nested_f>();
+  horizon::holds<mixed_h, horizon::mixed_f>();
+  horizon::retained<retained_h>();
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
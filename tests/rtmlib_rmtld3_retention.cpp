@@ -0,0 +1,148 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rmtlib_rmtld3 monitors that release the events behind the horizon of their
+ * formula
+ */
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/formulas.h>
+#include <rmtld3/horizon.h>
+#include <rmtld3/reader.h>
+
+struct retention_policy : RTML_buffer_policy {
+  typedef RTML_sequence_gap gap_detection;
+};
+
+// (a S[8] b) and a U[5] c
+typedef op_h<since_less_h<prop_h, prop_h, 8>, until_less_h<prop_h, prop_h, 5>>
+    retention_h;
+
+template <typename T> class Eval_retention_ab {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    return prop<T>(trace, 1, t);
+  };
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    return prop<T>(trace, 2, t);
+  };
+};
+
+template <typename T> class Eval_ac {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    return prop<T>(trace, 1, t);
+  };
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    return prop<T>(trace, 3, t);
+  };
+};
+
+namespace retention {
+
+const int events = 300;
+
+// an event every 2 time units
+const timespan arrival = 2;
+
+// the monitor evaluates the formula once its future horizon has arrived
+const timespan lag = RMTLD3_horizon<retention_h>::future + 2 * arrival;
+
+// b and c are apart, so that a S[8] b reads up to 4 events back
+Event<int> event(int i) {
+  return Event<int>((i % 7 == 0) ? 2 : ((i % 7 == 3) ? 3 : 1), arrival * i + 1);
+}
+
+template <typename T> three_valued_type compute(T &trace, timespan &t) {
+  three_valued_type since = since_less<T, Eval_retention_ab<T>, 8>(trace, t);
+  three_valued_type until = until_less<T, Eval_ac<T>, 5>(trace, t);
+  return b3_and(since, until);
+}
+
+/*
+ * A monitor of a buffer that holds the horizon of the formula and the events
+ * of the lag evaluates it as with the whole trace, and never finds a gap
+ * while it releases the events behind the horizon
+ */
+template <typename P, bool retain> void monitor() {
+  const size_t size = RMTLD3_horizon<retention_h>::events(arrival, lag);
+
+  typedef RTML_buffer<Event<int>, size, P> live_t;
+  typedef RTML_buffer<Event<int>, events> whole_t;
+  typedef RMTLD3_reader<RTML_reader<live_t>> live_trace_t;
+  typedef RMTLD3_reader<RTML_reader<whole_t>> whole_trace_t;
+
+  static whole_t whole;
+  static live_t live;
+
+  live_trace_t trace(live);
+  whole_trace_t reference(whole);
+  size_t gaps = 0;
+  bool first = true;
+
+  for (int i = 0; i < events; i++) {
+    Event<int> e = event(i);
+    live.push(e);
+    whole.push(e);
+
+    timespan t = e.getTime() - lag;
+    if (e.getTime() < lag + RMTLD3_horizon<retention_h>::past + 1)
+      continue;
+
+    // as the generated monitors; the first synchronization is a gap
+    if (trace.synchronize() == trace.GAP && !first)
+      gaps++;
+    first = false;
+    reference.synchronize();
+
+    timespan tt = t, ttt = t;
+    trace.set(tt);
+    reference.set(ttt);
+    three_valued_type out = compute(trace, tt);
+    assert(!retain || out == compute(reference, ttt));
+
+    if (retain) {
+      size_t length = trace.RTML_reader<live_t>::length();
+      size_t released = trace.template retain<retention_h>(t);
+      assert(trace.RTML_reader<live_t>::length() == length - released);
+      assert(trace.RTML_reader<live_t>::length() <= size);
+    }
+  }
+
+  // without retention the writer overwrites the window of the reader
+  assert(retain ? gaps == 0 : gaps > 0);
+}
+
+} // namespace retention
+
+extern "C" int rtmlib_rmtld3_retention();
+
+int rtmlib_rmtld3_retention() {
+
+  retention::monitor<retention_policy, true>();
+  retention::monitor<retention_policy, false>();
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
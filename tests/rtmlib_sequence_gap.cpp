@@ -0,0 +1,143 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib reader with gaps detected by slot sequence numbers
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct sequence_policy : RTML_buffer_policy {
+  typedef RTML_sequence_gap gap_detection;
+};
+
+struct ticket_sequence_policy : sequence_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+struct single_producer_sequence_policy : sequence_policy {
+  typedef RTML_single_producer writer_protocol;
+};
+
+template <typename B> void sequence_gap() {
+  static B buf;
+
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+  RTML_reader<B> reader = RTML_reader<B>(buf);
+
+  Event<int> e;
+  Event<int> events[100];
+  size_t n;
+
+  assert(reader.synchronize() == reader.GAP);
+  assert(reader.pull(e) == reader.UNAVAILABLE);
+
+  // every event has the same timestamp
+  for (int i = 0; i < 10; i++) {
+    e.set(i, 7);
+    writer.push_all(e);
+  }
+
+  // the reader takes every event without looking ahead
+  assert(reader.synchronize() == reader.NO_GAP);
+  for (int i = 0; i < 10; i++) {
+    assert(reader.pull(e) == reader.AVAILABLE);
+    assert(e.getData() == i);
+  }
+  assert(reader.pull(e) == reader.UNAVAILABLE);
+  assert(reader.lost() == 0);
+
+  // overwrite the next events of the reader with the same timestamp
+  for (int i = 10; i < 160; i++) {
+    e.set(i, 7);
+    writer.push_all(e);
+  }
+
+  assert(reader.synchronize() == reader.GAP);
+  assert(reader.lost() == 0);
+
+  // the gap of 50 events is counted exactly before synchronizing
+  for (int i = 160; i < 170; i++) {
+    e.set(i, 7);
+    writer.push_all(e);
+  }
+
+  assert(reader.gap() == reader.GAP);
+  assert(reader.lost() == 10);
+  assert(reader.pull(e) == reader.READER_OVERFLOW);
+  assert(reader.pull_n(events, 10, n) == reader.READER_OVERFLOW && n == 0);
+
+  assert(reader.synchronize() == reader.GAP);
+  assert(reader.lost() == 0);
+
+  assert(reader.pull_n(events, 60, n) == reader.AVAILABLE && n == 60);
+  for (size_t i = 0; i < n; i++)
+    assert(events[i].getData() == 70 + (int)i);
+
+  // a burst larger than the buffer loses its oldest events
+  Event<int> burst[120];
+  for (int i = 0; i < 120; i++) {
+    int d = 170 + i;
+    burst[i].set(d, 7);
+  }
+  writer.push_all_n(burst, 120);
+
+  // 40 events of the buffer and 20 events of the burst
+  assert(reader.lost() == 60);
+  assert(reader.synchronize() == reader.GAP);
+
+  for (int i = 190; i < 290; i++) {
+    assert(reader.pull(e) == reader.AVAILABLE);
+    assert(e.getData() == i);
+  }
+  assert(reader.pull(e) == reader.UNAVAILABLE);
+}
+
+extern "C" int rtmlib_sequence_gap();
+
+int rtmlib_sequence_gap() {
+
+  sequence_gap<RTML_buffer<Event<int>, 100, sequence_policy>>();
+
+  sequence_gap<RTML_buffer<Event<int>, 100, ticket_sequence_policy>>();
+
+  sequence_gap<
+      RTML_buffer<Event<int>, 100, single_producer_sequence_policy>>();
+
+  // the pushes of the buffer itself are numbered too
+  static RTML_buffer<Event<int>, 100, sequence_policy> buf;
+  Event<int> e;
+
+  for (int i = 0; i < 3; i++)
+    buf.push(e);
+
+  assert(buf.sequence(0) == 1 && buf.sequence(2) == 3);
+  assert(buf.pop(e) == buf.OK);
+  assert(buf.push(e) == buf.OK && buf.sequence(2) == 3);
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib sharded buffer read by the merge of its shards by timestamp
+ */
+
+#include <algorithm>
+#include <assert.h>
+#include <vector>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/formulas.h>
+#include <rmtld3/mergereader.h>
+#include <rmtld3/reader.h>
+#include <shardedbuffer.h>
+#include <writer.h>
+
+typedef RTML_sharded_buffer<Event<int>, 50, 3> sharded_t;
+typedef RMTLD3_merge_reader<sharded_t, int> merge_t;
+
+// the merge of the shards in one buffer
+typedef RTML_buffer<Event<int>, 200> merged_t;
+typedef RMTLD3_reader<RTML_reader<merged_t>, int> merged_trace_t;
+
+template <typename T> class Eval_sharded {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    return T_TRUE;
+  };
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    proposition p = 5;
+    return prop<T>(trace, p, t);
+  };
+};
+
+namespace sharded {
+
+struct sample {
+  timespan time;
+  size_t shard;
+  int data;
+
+  bool operator<(const sample &o) const {
+    return time < o.time || (time == o.time && shard < o.shard);
+  }
+};
+
+// shard 0 wraps around and the timestamps of the shards tie every third
+// event; the merged buffer gets the events kept by the shards in order
+void fill(sharded_t &buf, merged_t &merged) {
+  const int pushes[3] = {70, 30, 20};
+  std::vector<sample> kept;
+
+  for (size_t i = 0; i < 3; i++)
+    for (int j = 0; j < pushes[i]; j++) {
+      sample s = {(timespan)(5 * j + (j % 3 == 0 ? 0 : i)), i,
+                  (int)i * 4 + j % 4};
+      buf.shard(i).push(Event<int>(s.data, s.time));
+      if (j >= pushes[i] - 50)
+        kept.push_back(s);
+    }
+
+  std::sort(kept.begin(), kept.end());
+  for (size_t k = 0; k < kept.size(); k++)
+    merged.push(Event<int>(kept[k].data, kept[k].time));
+}
+
+bool same(const Event<int> &a, const Event<int> &b) {
+  return a.getTime() == b.getTime() && a.getData() == b.getData();
+}
+
+// the cursor moves over the merge as over the merged buffer
+void order(merge_t &trace, merged_trace_t &reference) {
+  Event<int> e, ee;
+  timespan t, tt;
+
+  assert(trace.length() == reference.length());
+
+  do {
+    assert(trace.read(e) == trace.AVAILABLE &&
+           reference.read(ee) == reference.AVAILABLE && same(e, ee));
+    assert(trace.read_time(t) == trace.AVAILABLE && t == e.getTime());
+    assert((int)trace.read_next_time(t) == (int)reference.read_next_time(tt) &&
+           (trace.length() <= 1 || t == tt));
+    assert((int)trace.read_next(e) == (int)reference.read_next(ee) &&
+           (trace.length() <= 1 || same(e, ee)));
+    reference.advance();
+  } while (trace.advance() == trace.AVAILABLE);
+
+  assert(trace.length() == 0 && trace.consumed() == reference.consumed());
+
+  while (trace.read_previous(e) == trace.AVAILABLE) {
+    assert(reference.read_previous(ee) == reference.AVAILABLE &&
+           same(e, ee));
+    assert(trace.read_previous_time(t) == trace.AVAILABLE &&
+           t == e.getTime());
+    trace.decrement_cursor();
+    reference.decrement_cursor();
+  }
+
+  assert(trace.consumed() == 0 && reference.consumed() == 0);
+}
+
+// set finds the same event as in the merged buffer from any cursor
+void set(merge_t &trace, merged_trace_t &reference) {
+  Event<int> e, ee;
+
+  for (timespan t = 0; t < 400; t += 3) {
+    for (size_t c = 0; c < 100; c += 17) {
+      trace.reset();
+      reference.reset();
+      size_t cc = c;
+      trace.set_cursor(cc);
+      for (size_t i = 0; i < c; i++)
+        reference.increment_cursor();
+
+      timespan tt = t, ttt = t;
+      assert(trace.set(tt) == (int)reference.set(ttt));
+      assert(trace.consumed() == reference.consumed());
+      assert(trace.read(e) == trace.AVAILABLE &&
+             reference.read(ee) == reference.AVAILABLE && same(e, ee));
+    }
+  }
+}
+
+// the formulas evaluate the merge as the merged buffer from the time set
+void formula(merge_t &trace, merged_trace_t &reference) {
+  for (timespan t = 0; t < 300; t += 4) {
+    timespan tt = t, ttt = t;
+
+    // as the generated monitors
+    trace.set(tt);
+    reference.set(ttt);
+
+    three_valued_type out =
+        until_less<merge_t, Eval_sharded<merge_t>, 22>(trace, tt);
+    three_valued_type expected =
+        until_less<merged_trace_t, Eval_sharded<merged_trace_t>, 22>(
+            reference, ttt);
+    assert(out == expected);
+  }
+}
+
+#ifndef NO_THREADS
+
+#include <task_compat.h>
+
+const int pushes = 40;
+
+sharded_t concurrent_buf;
+
+// each producer claims a shard and pushes timestamped events to it
+void *producer(void *) {
+  sharded_t::shard_t *shard = concurrent_buf.claim();
+  assert(shard != NULL);
+  RTML_writer<sharded_t::shard_t> writer =
+      RTML_writer<sharded_t::shard_t>(*shard);
+
+  for (int i = 0; i < pushes; i++) {
+    Event<int> e = Event<int>(i, 0);
+    writer.push(e);
+  }
+
+  return NULL;
+}
+
+void concurrent() {
+  pthread_t thread[3];
+
+  for (int i = 0; i < 3; i++)
+    pthread_create(&thread[i], NULL, producer, NULL);
+  for (int i = 0; i < 3; i++)
+    pthread_join(thread[i], NULL);
+
+  // all shards are claimed
+  assert(concurrent_buf.claim() == NULL);
+
+  int tzero = 0;
+  static merge_t trace = merge_t(concurrent_buf, tzero);
+  trace.synchronize();
+  assert(trace.length() == 3 * pushes);
+
+  timespan t, last = 0;
+  while (trace.read_time(t) == trace.AVAILABLE) {
+    assert(last <= t);
+    last = t;
+    trace.advance();
+  }
+  assert(trace.consumed() == 3 * pushes);
+}
+
+#endif
+
+} // namespace sharded
+
+extern "C" int rtmlib_sharded_buffer();
+
+int rtmlib_sharded_buffer() {
+
+  static sharded_t buf;
+  static merged_t merged;
+  sharded::fill(buf, merged);
+
+  int tzero = 0;
+  static merge_t trace = merge_t(buf, tzero);
+  static merged_trace_t reference = merged_trace_t(merged, tzero);
+  trace.synchronize();
+  reference.synchronize();
+  assert(trace.length() == buf.length() && trace.length() == 100);
+
+  sharded::order(trace, reference);
+  sharded::set(trace, reference);
+  sharded::formula(trace, reference);
+
+#ifndef NO_THREADS
+  sharded::concurrent();
+#endif
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib buffer in shared memory written by another process
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct relative_policy : RTML_buffer_policy {
+  typedef RTML_relative_address<2> address_mode;
+};
+
+struct shared_ticket_policy : RTML_buffer_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+typedef RTML_buffer<Event<int>, 100, relative_policy> relative_buffer_t;
+
+#if defined(__linux__)
+
+#include <shm_compat.h>
+#include <sys/wait.h>
+
+namespace shm {
+
+const int pushes = 1000;
+
+// the application pushes from a new mapping of the segment
+template <typename B> void application(const char *name, void *monitor) {
+  RTML_shared_buffer<B> shm;
+  assert(shm.attach(name) == shm.OK);
+  assert((void *)&shm.buffer() != monitor);
+
+  RTML_writer<B> writer = RTML_writer<B>(shm.buffer());
+  for (int i = 0; i < pushes; i++) {
+    Event<int> e = Event<int>(i, 0);
+    assert(writer.push(e) != shm.buffer().UNSAFE);
+  }
+}
+
+template <typename B> void monitor(const char *name) {
+  RTML_shared_buffer<B> shm;
+
+  RTML_shared_buffer<B>::unlink(name);
+  assert(shm.attach(name) == shm.NOT_FOUND);
+  assert(shm.create(name) == shm.OK);
+
+  pid_t pid = fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    application<B>(name, &shm.buffer());
+    _exit(0);
+  }
+
+  int status;
+  assert(waitpid(pid, &status, 0) == pid);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  // the monitor reads the events in place
+  B &buf = shm.buffer();
+  RTML_reader<B> reader = RTML_reader<B>(buf);
+  Event<int> e;
+
+  assert(buf.length() == buf.size_util);
+  reader.synchronize();
+  for (int i = pushes - buf.size_util; i < pushes - 1; i++) {
+    assert(reader.pull(e) == reader.AVAILABLE);
+    assert(e.getData() == i);
+  }
+
+  shm.detach();
+  assert(RTML_shared_buffer<B>::unlink(name) == RTML_shared_buffer<B>::OK);
+}
+
+} // namespace shm
+
+#endif
+
+extern "C" int rtmlib_shared_buffer();
+
+int rtmlib_shared_buffer() {
+
+  // the page refers to writer states by offset, so copies keep working
+  static relative_buffer_t buf;
+  static relative_buffer_t copy;
+
+  RTML_writer<relative_buffer_t> writer =
+      RTML_writer<relative_buffer_t>(buf);
+
+  Event<int> e;
+  for (int i = 0; i < 10; i++) {
+    e.setData(i);
+    assert(writer.push(e) == buf.OK);
+  }
+
+  copy = buf;
+  assert(copy.length() == 10);
+  for (int i = 0; i < 10; i++)
+    assert(copy.pull(e) == copy.OK && e.getData() == i);
+
+  // the buffer keeps the states of two writers only
+  RTML_writer<relative_buffer_t> second = RTML_writer<relative_buffer_t>(buf);
+  RTML_writer<relative_buffer_t> third = RTML_writer<relative_buffer_t>(buf);
+
+  assert(second.push(e) == buf.OK);
+  assert(third.push(e) == buf.UNSAFE);
+  assert(third.push_all_n(&e, 1) == buf.UNSAFE);
+  assert(buf.length() == 11);
+
+#if defined(__linux__)
+  shm::monitor<relative_buffer_t>("/rtmlib_shared_buffer");
+  shm::monitor<RTML_buffer<Event<int>, 100, shared_ticket_policy>>(
+      "/rtmlib_shared_buffer");
+#endif
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib reader and writer using the single producer writer protocol
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct single_producer_policy : RTML_buffer_policy {
+  typedef RTML_single_producer writer_protocol;
+};
+
+typedef RTML_buffer<Event<int>, 100, single_producer_policy> sp_buffer_t;
+
+#ifndef NO_THREADS
+
+#include <task_compat.h>
+
+namespace single_producer {
+
+const int readers = 2;
+const int pushes = 20000;
+
+sp_buffer_t buf;
+
+void *producer(void *) {
+  RTML_writer<sp_buffer_t> writer = RTML_writer<sp_buffer_t>(buf);
+
+  for (int i = 0; i < pushes; i++) {
+    Event<int> e = Event<int>(i, 0);
+    writer.push(e);
+  }
+
+  return NULL;
+}
+
+void *consumer(void *) {
+  RTML_reader<sp_buffer_t> reader = RTML_reader<sp_buffer_t>(buf);
+  Event<int> e;
+  int last = -1;
+
+  // each reader sees the events of the producer in order (SPMC)
+  while (last < pushes - 2) {
+    if (reader.pull(e) == reader.AVAILABLE) {
+      assert(e.getData() > last);
+      last = e.getData();
+    } else {
+      reader.synchronize();
+      sched_yield();
+    }
+  }
+
+  return NULL;
+}
+
+void concurrent() {
+  pthread_t thread[readers + 1];
+
+  for (int i = 0; i < readers; i++)
+    assert(!pthread_create(&thread[i], NULL, consumer, NULL));
+
+  assert(!pthread_create(&thread[readers], NULL, producer, NULL));
+
+  for (int i = 0; i <= readers; i++)
+    assert(!pthread_join(thread[i], NULL));
+
+  assert(buf.control.top.load() == pushes);
+  assert(buf.length() == buf.size_util);
+}
+
+} // namespace single_producer
+
+#endif
+
+extern "C" int rtmlib_single_producer();
+
+int rtmlib_single_producer() {
+
+  static sp_buffer_t buf;
+  int ID = 0x01;
+
+  RTML_reader<sp_buffer_t> reader = RTML_reader<sp_buffer_t>(buf);
+
+  RTML_writer<sp_buffer_t> writer = RTML_writer<sp_buffer_t>(buf);
+
+  Event<int> node0 = Event<int>();
+
+  assert(buf.length() == 0);
+  assert(buf.pull(node0) == buf.EMPTY);
+  assert(buf.pop(node0) == buf.EMPTY);
+  assert(reader.pull(node0) == reader.UNAVAILABLE);
+
+  // fill and overload the buffer with the writer (+11 overload)
+  Event<int> nodex = Event<int>();
+  long int i;
+  for (i = 0; i < 111; i++) {
+    nodex.set(ID, i);
+
+    if (i >= buf.size_util)
+      assert(writer.push_all(nodex) == buf.BUFFER_OVERFLOW);
+    else
+      assert(writer.push_all(nodex) == buf.OK);
+  }
+
+  assert(buf.length() == buf.size_util);
+
+  // a second writer is rejected and writes nothing
+  RTML_writer<sp_buffer_t> other = RTML_writer<sp_buffer_t>(buf);
+  nodex.set(ID, 500);
+  assert(other.push_all(nodex) == buf.UNSAFE);
+  assert(other.push(nodex) == buf.UNSAFE);
+  assert(other.push_all_n(&nodex, 1) == buf.UNSAFE);
+  other.reserve().set(ID, 500);
+  assert(other.commit() == buf.UNSAFE);
+
+  // so is a copy of the first writer
+  RTML_writer<sp_buffer_t> copy(writer);
+  assert(copy.push_all(nodex) == buf.UNSAFE);
+  assert(buf.control.top.load() == 111);
+
+  // the reader sees the last N events in order
+  assert(reader.synchronize() == reader.GAP);
+
+  for (i = 11; i < 110; i++) {
+    assert(reader.pull(nodex) == reader.AVAILABLE);
+    assert(nodex.getTime() == i);
+  }
+
+  // pull and pop from the buffer itself
+  assert(buf.pop(nodex) == buf.UNSAFE && nodex.getTime() == 110);
+  assert(buf.pull(nodex) == buf.UNSAFE && nodex.getTime() == 11);
+  assert(buf.length() == buf.size_util - 2);
+
+  for (i = 0; i < 110; i++) {
+    if (i >= buf.size_util - 2)
+      assert(buf.pull(nodex) == buf.EMPTY);
+    else
+      assert(buf.pull(nodex) == buf.UNSAFE && nodex.getTime() == i + 12);
+  }
+
+  // a burst is published with a single store
+  Event<int> burst[10];
+  for (i = 0; i < 10; i++)
+    burst[i].set(ID, 200 + i);
+
+  size_t discarded;
+  assert(writer.push_all_n(burst, 10, discarded) == buf.OK && discarded == 0);
+  assert(buf.length() == 10);
+
+  // events built in place
+  Event<int> &e = writer.reserve();
+  e.setData(ID);
+  assert(buf.length() == 10);
+  assert(writer.commit() == buf.OK);
+  assert(buf.length() == 11);
+
+  for (i = 0; i < 10; i++)
+    assert(buf.pull(nodex) == buf.UNSAFE && nodex.getTime() == 200 + i);
+
+#ifndef NO_THREADS
+  single_producer::concurrent();
+#endif
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
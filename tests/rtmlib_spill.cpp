@@ -0,0 +1,147 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib readers behind the buffer read the overwritten events from a spill
+ * file
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <spill_compat.h>
+#include <writer.h>
+
+struct spill_policy : RTML_buffer_policy {
+  typedef RTML_sequence_gap gap_detection;
+  typedef RTML_file_spill spill;
+};
+
+struct spill_ticket_policy : spill_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+struct spill_single_producer_policy : spill_policy {
+  typedef RTML_single_producer writer_protocol;
+};
+
+namespace spill {
+
+// the data of each event is its position in the trace
+template <typename B> void push(RTML_writer<B> &writer, int &next, int n) {
+  for (int i = 0; i < n; i++) {
+    Event<int> e = Event<int>(next++, 0);
+    writer.push(e);
+  }
+}
+
+// pull the events from first to last, one at a time or in batches
+template <typename B>
+void expect(RTML_reader<B> &reader, int first, int last, bool batch) {
+  Event<int> e[4];
+  int next = first;
+
+  while (next <= last) {
+    size_t n = 1;
+    typename RTML_reader<B>::error_t err =
+        batch ? reader.pull_n(e, (last - next < 3) ? last - next + 1 : 4, n)
+              : reader.pull(e[0]);
+    assert(err == reader.AVAILABLE);
+    for (size_t i = 0; i < n; i++)
+      assert(e[i].getData() == next++);
+  }
+
+  assert(next == last + 1);
+}
+
+template <typename B, bool batch> void recover() {
+  static B buf;
+  static RTML_writer<B> writer = RTML_writer<B>(buf);
+  static int next;
+  Event<int> e;
+
+  char path[] = "/tmp/rtmlib_spill_XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  close(fd);
+
+  RTML_spill_file<B> file;
+  assert(file.create(path, 64, buf) == file.OK);
+
+  RTML_reader<B> reader = RTML_reader<B>(buf);
+
+  push(writer, next, 5);
+  assert(reader.synchronize() == reader.GAP);
+  expect(reader, 0, 1, batch);
+
+  // the events of the reader are overwritten while it reads them
+  push(writer, next, 30);
+  expect(reader, 2, 4, batch);
+  assert(reader.pull(e) == reader.UNAVAILABLE);
+
+  // the gap is read from the spill
+  assert(reader.synchronize() == reader.NO_GAP);
+  expect(reader, 5, 34, batch);
+
+  // the spill keeps the last 64 overwritten events only
+  push(writer, next, 100);
+  assert(reader.synchronize() == reader.GAP);
+  expect(reader, 125, 134, batch);
+
+  // the spill overwrites the rest of the gap while the reader reads it
+  push(writer, next, 70);
+  assert(reader.synchronize() == reader.NO_GAP);
+  expect(reader, 135, 139, batch);
+  push(writer, next, 64);
+  assert(reader.pull(e) == reader.READER_OVERFLOW);
+  expect(reader, 195, 204, batch);
+  assert(reader.synchronize() == reader.NO_GAP);
+  expect(reader, 205, 268, batch);
+  assert(reader.pull(e) == reader.UNAVAILABLE);
+
+  file.detach();
+  unlink(path);
+
+  // without the file the events are lost
+  push(writer, next, 20);
+  assert(reader.synchronize() == reader.GAP);
+  expect(reader, 279, 288, batch);
+}
+
+} // namespace spill
+
+extern "C" int rtmlib_spill();
+
+int rtmlib_spill() {
+
+  spill::recover<RTML_buffer<Event<int>, 10, spill_policy>, false>();
+  spill::recover<RTML_buffer<Event<int>, 10, spill_policy>, true>();
+  spill::recover<RTML_buffer<Event<int>, 10, spill_ticket_policy>, false>();
+  spill::recover<RTML_buffer<Event<int>, 10, spill_single_producer_policy>,
+                 false>();
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
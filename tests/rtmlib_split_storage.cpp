@@ -0,0 +1,152 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib buffer keeping timestamps and payloads in separate arrays
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/formulas.h>
+#include <rmtld3/reader.h>
+#include <writer.h>
+
+struct split_policy : RTML_buffer_policy {
+  typedef RTML_split_storage storage;
+};
+
+struct versioned_split_policy : split_policy {
+  typedef RTML_versioned_slot slot_mode;
+};
+
+struct ticket_split_policy : split_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+namespace split {
+
+template <typename T> class Eval_eventually {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    return T_TRUE;
+  };
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    proposition p = 2;
+    return prop<T>(trace, p, t);
+  };
+};
+
+template <typename B> void push_and_read() {
+  static B buf;
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+
+  Event<int> e;
+
+  // wrap the ring with bursts and reservations
+  for (int i = 0; i < 30; i++) {
+    Event<int> burst[3];
+    for (int j = 0; j < 3; j++) {
+      int d = i * 4 + j;
+      burst[j].set(d, d * 10);
+    }
+    writer.push_all_n(burst, 3);
+
+    Event<int> &slot = writer.reserve();
+    int d = i * 4 + 3;
+    timespan t = d * 10;
+    slot.set(d, t);
+    writer.commit();
+  }
+
+  size_t b, t;
+  buf.state(b, t);
+  assert(buf.length() == 100);
+
+  // the timestamps are read alone or with their payloads
+  for (size_t i = 0; i < 100; i++) {
+    size_t index = B::index_t::advance(b, i);
+    timespan time;
+    assert(buf.read_time(time, index) == buf.OK);
+    assert(buf.read(e, index) == buf.OK);
+    assert(time == e.getTime() && time == (timespan)(20 + i) * 10);
+    assert(e.getData() == (int)(20 + i));
+  }
+
+  timespan time;
+  assert(buf.read_time(time, buf.size) == buf.OUT_OF_BOUND);
+}
+
+// the evaluation of a formula only compares timestamps until a proposition
+// is checked
+template <typename B> void eventually() {
+  typedef RMTLD3_reader<RTML_reader<B>, int> trace_t;
+
+  static B buf;
+
+  Event<int> e[7] = {
+      Event<int>(1, 2),  Event<int>(3, 5),  Event<int>(1, 9),
+      Event<int>(3, 14), Event<int>(1, 19), Event<int>(2, 21),
+      Event<int>(3, 25),
+  };
+
+  for (int i = 0; i < 7; i++)
+    buf.push(e[i]);
+
+  int tzero = 0;
+  trace_t trace = trace_t(buf, tzero);
+  trace.synchronize();
+
+  timespan t = 2;
+  three_valued_type out =
+      until_less<trace_t, Eval_eventually<trace_t>, 22>(trace, t);
+  assert(out == T_TRUE);
+
+  // the cursor is set by time
+  t = 15;
+  assert(trace.set(t) == trace.AVAILABLE);
+  timespan time;
+  assert(trace.read_time(time) == trace.AVAILABLE && time == 14);
+}
+
+} // namespace split
+
+extern "C" int rtmlib_split_storage();
+
+int rtmlib_split_storage() {
+
+  // the timestamps are contiguous
+  typedef RTML_slot_storage<Event<int>, 16, RTML_split_storage> storage_t;
+  static_assert(sizeof(((storage_t *)0)->times) == 16 * sizeof(timespan),
+                "timestamps are not contiguous");
+
+  split::push_and_read<RTML_buffer<Event<int>, 100, split_policy>>();
+  split::push_and_read<RTML_buffer<Event<int>, 100, versioned_split_policy>>();
+  split::push_and_read<RTML_buffer<Event<int>, 100, ticket_split_policy>>();
+
+  split::eventually<RTML_buffer<Event<int>, 100, split_policy>>();
+  split::eventually<RTML_buffer<Event<int>, 100>>();
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib reader and writer using the ticket writer protocol
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct ticket_policy : RTML_buffer_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+typedef RTML_buffer<Event<int>, 100, ticket_policy> ticket_buffer_t;
+
+#ifndef NO_THREADS
+
+#include <task_compat.h>
+
+namespace ticket {
+
+const int writers = 4;
+const int pushes = 1000;
+
+ticket_buffer_t buf;
+
+void *producer(void *id) {
+  RTML_writer<ticket_buffer_t> writer = RTML_writer<ticket_buffer_t>(buf);
+
+  for (int i = 0; i < pushes; i++) {
+    Event<int> e = Event<int>((long)id * pushes + i, 0);
+    writer.push(e);
+  }
+
+  return NULL;
+}
+
+void concurrent() {
+  pthread_t thread[writers];
+
+  for (long i = 0; i < writers; i++)
+    assert(!pthread_create(&thread[i], NULL, producer, (void *)i));
+
+  for (int i = 0; i < writers; i++)
+    assert(!pthread_join(thread[i], NULL));
+
+  // every ticket is published, the last N events are ordered per writer and
+  // their timestamps follow the order of the slots
+  assert(buf.control.reserve.load() == writers * pushes);
+  assert(buf.length() == buf.size_util);
+
+  int last[writers] = {};
+  timespan time = 0;
+  Event<int> e;
+  while (buf.pull(e) != buf.EMPTY) {
+    int w = e.getData() / pushes;
+    assert(w < writers && last[w] <= e.getData());
+    last[w] = e.getData();
+    assert(time <= e.getTime());
+    time = e.getTime();
+  }
+}
+
+ticket_buffer_t lapped_buf;
+volatile bool lapping_done = false;
+
+void *lapping(void *) {
+  RTML_writer<ticket_buffer_t> writer(lapped_buf);
+
+  // the last push takes the slot of the ticket held by the other writer
+  for (int i = 1; i <= (int)lapped_buf.size; i++) {
+    Event<int> e = Event<int>(i, i);
+    writer.push_all(e);
+  }
+
+  lapping_done = true;
+  return NULL;
+}
+
+void lapped() {
+  RTML_writer<ticket_buffer_t> writer(lapped_buf);
+  pthread_t thread;
+
+  Event<int> &slot = writer.reserve();
+  assert(!pthread_create(&thread, NULL, lapping, NULL));
+
+  // the lapping writer waits until the held ticket is published
+  nanosleep((const struct timespec[]){{0, 50000000L}}, NULL);
+  assert(!lapping_done);
+
+  int data = -1;
+  slot.setData(data);
+  assert(writer.commit() == lapped_buf.OK);
+  assert(!pthread_join(thread, NULL) && lapping_done);
+
+  // the newer event is kept in the shared slot
+  Event<int> e;
+  for (int i = 2; i <= (int)lapped_buf.size; i++) {
+    assert(lapped_buf.pull(e) != lapped_buf.EMPTY);
+    assert(e.getData() == i);
+  }
+  assert(lapped_buf.pull(e) == lapped_buf.EMPTY);
+}
+
+} // namespace ticket
+
+#endif
+
+extern "C" int rtmlib_ticket_reader_and_writer();
+
+int rtmlib_ticket_reader_and_writer() {
+
+  static ticket_buffer_t buf;
+  int ID = 0x01;
+
+  RTML_reader<ticket_buffer_t> reader = RTML_reader<ticket_buffer_t>(buf);
+
+  RTML_writer<ticket_buffer_t> writer = RTML_writer<ticket_buffer_t>(buf);
+
+  Event<int> node0 = Event<int>();
+
+  assert(buf.length() == 0);
+  assert(buf.pull(node0) == buf.EMPTY);
+  assert(buf.pop(node0) == buf.EMPTY);
+  assert(reader.pull(node0) == reader.UNAVAILABLE);
+
+  // fill and overload the buffer with the writer (+11 overload)
+  Event<int> nodex = Event<int>();
+  long int i;
+  for (i = 0; i < 111; i++) {
+    nodex.set(ID, i);
+
+    if (i >= buf.size_util)
+      assert(writer.push_all(nodex) == buf.BUFFER_OVERFLOW);
+    else
+      assert(writer.push_all(nodex) == buf.OK);
+  }
+
+  assert(buf.length() == buf.size_util);
+
+  // the reader sees the last N events in order
+  assert(reader.synchronize() == reader.GAP);
+
+  for (i = 11; i < 110; i++) {
+    assert(reader.pull(nodex) == reader.AVAILABLE);
+    assert(nodex.getTime() == i);
+  }
+
+  // pull and pop from the buffer itself
+  assert(buf.pop(nodex) == buf.OK && nodex.getTime() == 110);
+  assert(buf.pull(nodex) == buf.OK && nodex.getTime() == 11);
+  assert(buf.length() == buf.size_util - 2);
+
+  for (i = 0; i < 110; i++) {
+    if (i >= buf.size_util - 2)
+      assert(buf.pull(nodex) == buf.EMPTY);
+    else
+      assert(buf.pull(nodex) == buf.OK && nodex.getTime() == i + 12);
+  }
+
+  // the slot released by pop is reused by the next push
+  nodex.set(ID, 200);
+  assert(writer.push_all(nodex) == buf.OK);
+  assert(buf.pull(nodex) == buf.OK && nodex.getTime() == 200);
+
+#ifndef NO_THREADS
+  ticket::concurrent();
+  ticket::lapped();
+#endif
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
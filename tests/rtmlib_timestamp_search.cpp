@@ -0,0 +1,189 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib search of timestamps with the vector kernels and RMTLD3_reader::set
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/reader.h>
+#include <writer.h>
+
+struct search_split_policy : RTML_buffer_policy {
+  typedef RTML_split_storage storage;
+};
+
+struct search_delta_policy : RTML_buffer_policy {
+  typedef RTML_delta_storage<uint32_t, 8> storage;
+};
+
+// bisect down to two events
+template <typename S> struct bisect_policy : RTML_buffer_policy {
+  typedef S storage;
+  static const size_t search_window = 2;
+};
+
+namespace search {
+
+// the walk of RMTLD3_reader::set one event at a time
+template <typename T> typename T::error_t walk(T &trace, timespan &t) {
+  Event<int> e, ee;
+
+  while (trace.read_previous(e) == trace.AVAILABLE &&
+         trace.read(ee) == trace.AVAILABLE) {
+    if (e.getTime() <= t && t < ee.getTime())
+      return trace.AVAILABLE;
+    trace.decrement_cursor();
+  }
+
+  while (trace.read(ee) == trace.AVAILABLE &&
+         trace.read_next(e) == trace.AVAILABLE) {
+    if (ee.getTime() <= t && t < e.getTime())
+      return trace.AVAILABLE;
+    trace.increment_cursor();
+  }
+
+  return trace.UNAVAILABLE;
+}
+
+// the kernel agrees with the scalar scan on any length and position
+void kernel() {
+  timespan times[64];
+
+  for (int round = 0; round < 100; round++) {
+    timespan t = rand() % 10;
+    for (int i = 0; i < 64; i++) {
+      t += rand() % 3;
+      times[i] = t;
+    }
+
+    for (size_t n = 0; n <= 64; n++) {
+      timespan key = rand() % (t + 2);
+      assert(RTML_upper_bound(times, n, key) ==
+             RTML_upper_bound_scalar(times, n, key));
+    }
+  }
+}
+
+// set finds the same cursor as the walk from any cursor, for timestamps
+// that wrap around the end of the ring and repeat
+template <typename B> void set() {
+  typedef RMTLD3_reader<RTML_reader<B>, int> trace_t;
+
+  static B buf;
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+
+  Event<int> e;
+  for (int i = 0; i < 150; i++) {
+    int d = i;
+    e.set(d, 100 + i * 10 - (i % 7 == 0 ? 10 : 0));
+    writer.push_all(e);
+  }
+
+  int tzero = 0;
+  trace_t trace = trace_t(buf, tzero), reference = trace_t(buf, tzero);
+  trace.synchronize();
+  reference.synchronize();
+  reference.reset();
+
+  for (timespan t = 500; t < 1700; t += 7) {
+    for (size_t c = 0; c < 100; c += 13) {
+      trace.reset();
+      reference.reset();
+      for (size_t i = 0; i < c; i++) {
+        trace.increment_cursor();
+        reference.increment_cursor();
+      }
+
+      timespan tt = t;
+      assert(trace.set(tt) == walk(reference, tt));
+      assert(trace.get_cursor() == reference.get_cursor());
+    }
+  }
+}
+
+// the bisection of both runs of the ring agrees with a count of the
+// timestamps up to t, for any window of the buffer
+template <typename B> void bisect() {
+  static B buf;
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+
+  Event<int> e;
+  for (int i = 0; i < 130; i++) {
+    int d = i;
+    e.set(d, 100 + (i / 3) * 10);
+    writer.push_all(e);
+  }
+
+  size_t bottom, top;
+  buf.state(bottom, top);
+  size_t n = buf.length();
+  assert(n == buf.size_util);
+
+  for (timespan t = 90; t < 600; t += 5) {
+    for (size_t k = 0; k <= n; k += 11) {
+      size_t index = B::index_t::advance(bottom, n - k);
+      size_t expected = 0;
+      timespan et;
+      for (size_t i = 0; i < k; i++) {
+        assert(buf.read_time(et, B::index_t::advance(index, i)) == buf.OK);
+        if (et <= t)
+          expected++;
+      }
+      assert(buf.upper_bound(t, index, k) == expected);
+    }
+  }
+}
+
+} // namespace search
+
+extern "C" int rtmlib_timestamp_search();
+
+int rtmlib_timestamp_search() {
+
+  search::kernel();
+
+  search::set<RTML_buffer<Event<int>, 100>>();
+  search::set<RTML_buffer<Event<int>, 100, search_split_policy>>();
+  search::set<RTML_buffer<Event<int>, 100, search_delta_policy>>();
+
+  search::bisect<RTML_buffer<Event<int>, 100>>();
+  search::bisect<RTML_buffer<Event<int>, 100, search_split_policy>>();
+  search::bisect<
+      RTML_buffer<Event<int>, 100, bisect_policy<RTML_event_storage>>>();
+  search::bisect<
+      RTML_buffer<Event<int>, 100, bisect_policy<RTML_split_storage>>>();
+  search::bisect<RTML_buffer<Event<int>, 100,
+                             bisect_policy<RTML_delta_storage<uint32_t, 8>>>>();
+
+  search::set<
+      RTML_buffer<Event<int>, 100, bisect_policy<RTML_split_storage>>>();
+  search::set<RTML_buffer<Event<int>, 100,
+                          bisect_policy<RTML_delta_storage<uint32_t, 8>>>>();
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
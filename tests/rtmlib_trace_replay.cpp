@@ -0,0 +1,227 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib traces recorded from a reader to a file and replayed from its
+ * mapping
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <rmtld3/formulas.h>
+#include <rmtld3/reader.h>
+#include <trace_compat.h>
+
+struct trace_policy : RTML_buffer_policy {
+  typedef RTML_sequence_gap gap_detection;
+};
+
+typedef RTML_buffer<Event<int>, 100, trace_policy> live_t;
+
+// the recorded trace in one buffer
+typedef RTML_buffer<Event<int>, 1000> reference_t;
+typedef RMTLD3_reader<RTML_reader<reference_t>, int> reference_trace_t;
+
+typedef RTML_trace_buffer<Event<int>> replay_t;
+typedef RMTLD3_reader<RTML_reader<replay_t>, int> replay_trace_t;
+
+template <typename T> class Eval_replay {
+public:
+  static three_valued_type eval_phi1(T &trace, timespan &t) {
+    proposition p = 1;
+    return prop<T>(trace, p, t);
+  };
+  static three_valued_type eval_phi2(T &trace, timespan &t) {
+    proposition p = 2;
+    return prop<T>(trace, p, t);
+  };
+};
+
+namespace replay {
+
+const int events = 600;
+
+// the blocks of the file do not hold a multiple of the batches recorded
+const size_t block = 64;
+
+Event<int> event(int i) { return Event<int>(i % 3 + 1, 3 * i + i % 2); }
+
+void record(const char *path, reference_t &reference) {
+  static live_t buf;
+  RTML_reader<live_t> reader = RTML_reader<live_t>(buf);
+  RTML_trace_recorder<Event<int>, block> recorder;
+
+  assert(recorder.create(path) == recorder.OK);
+  assert(recorder.proposition(1, "a") == recorder.OK);
+  assert(recorder.proposition(2, "bb") == recorder.OK);
+  assert(recorder.proposition(3, "request_sent") == recorder.OK);
+
+  // the live buffer holds fewer events than the trace
+  size_t recorded = 0;
+  for (int i = 0; i < events; i++) {
+    Event<int> e = event(i);
+    buf.push(e);
+    reference.push(e);
+
+    size_t count;
+    if (i % 50 == 49) {
+      assert(recorder.record(reader, count) == recorder.OK);
+      recorded += count;
+    }
+  }
+  assert(recorded == events);
+
+  // the dictionary precedes the events
+  assert(recorder.proposition(4, "late") == recorder.FAILED);
+
+  // an event before the last one is not appended
+  Event<int> late = event(events - 2);
+  assert(recorder.append(&late, 1) == recorder.FAILED);
+
+  assert(recorder.close() == recorder.OK);
+}
+
+void read(const replay_t &trace) {
+  assert(trace.length() == events);
+
+  for (int i = 0; i < events; i++) {
+    Event<int> e;
+    timespan t;
+    assert(trace.read(e, i) == trace.OK);
+    assert(e.getData() == event(i).getData());
+    assert(e.getTime() == event(i).getTime());
+    assert(trace.read_time(t, i) == trace.OK && t == e.getTime());
+  }
+
+  Event<int> e[150];
+  assert(trace.read(e, 150, 40) == trace.OK);
+  for (int i = 0; i < 150; i++)
+    assert(e[i].getTime() == event(40 + i).getTime());
+
+  assert(trace.read(e[0], events) == trace.OUT_OF_BOUND);
+  assert(trace.read(e, 2, events - 1) == trace.OUT_OF_BOUND);
+
+  // the search counts the events up to each time
+  for (timespan t = 0; t < 3 * events; t += 7) {
+    size_t k = trace.upper_bound(t, 10, 500);
+    size_t expected = 0;
+    while (expected < 500 && event(10 + expected).getTime() <= t)
+      expected++;
+    assert(k == expected);
+  }
+
+  const char *names[] = {"a", "bb", "request_sent"};
+  assert(trace.propositions() == 3);
+  for (size_t i = 0; i < 3; i++) {
+    uint32_t id, length;
+    const char *name;
+    assert(trace.proposition(i, id, name, length));
+    assert(id == i + 1 && length == strlen(names[i]) &&
+           strncmp(name, names[i], length) == 0);
+  }
+}
+
+// the formulas evaluate the replay as the buffer with the recorded trace
+void formula(replay_trace_t &trace, reference_trace_t &reference) {
+  for (timespan t = 0; t < 3 * events; t += 5) {
+    timespan tt = t, ttt = t;
+
+    // as the generated monitors
+    trace.set(tt);
+    reference.set(ttt);
+
+    three_valued_type out =
+        until_less<replay_trace_t, Eval_replay<replay_trace_t>, 10>(trace,
+                                                                    tt);
+    three_valued_type expected =
+        until_less<reference_trace_t, Eval_replay<reference_trace_t>, 10>(
+            reference, ttt);
+    assert(out == expected);
+  }
+}
+
+} // namespace replay
+
+extern "C" int rtmlib_trace_replay();
+
+int rtmlib_trace_replay() {
+
+  char path[] = "/tmp/rtmlib_trace_XXXXXX";
+  int fd = mkstemp(path);
+  assert(fd >= 0);
+  close(fd);
+
+  static reference_t reference;
+  replay::record(path, reference);
+
+  static replay_t trace;
+  assert(trace.open(path) == trace.OPENED);
+  replay::read(trace);
+
+  int tzero = 0;
+  replay_trace_t replayed = replay_trace_t(trace, tzero);
+  reference_trace_t expected = reference_trace_t(reference, tzero);
+  replayed.synchronize();
+  expected.synchronize();
+  assert(replayed.length() == expected.length());
+  replay::formula(replayed, expected);
+
+  // a trace with more blocks than the file holds is not read, even when
+  // the sizes of the blocks wrap around to fit in the file
+  fd = open(path, O_RDWR);
+  assert(fd >= 0);
+  uint64_t counts[2], wrapped[2] = {1, ((uint64_t)1 << 59) + 1};
+  off_t counts_offset = offsetof(RTML_trace_header, events);
+  assert(pread(fd, counts, sizeof(counts), counts_offset) == sizeof(counts));
+  assert(pwrite(fd, wrapped, sizeof(wrapped), counts_offset) ==
+         sizeof(wrapped));
+  assert(trace.open(path) == trace.INCOMPATIBLE);
+  assert(pwrite(fd, counts, sizeof(counts), counts_offset) ==
+         sizeof(counts));
+  close(fd);
+  assert(trace.open(path) == trace.OPENED);
+
+  // a trace with a dictionary entry past the dictionary is not read
+  fd = open(path, O_WRONLY);
+  assert(fd >= 0);
+  uint32_t length = 1000;
+  off_t third = sizeof(RTML_trace_header) + 2 * 16 + sizeof(uint32_t);
+  assert(pwrite(fd, &length, sizeof(length), third) == sizeof(length));
+  close(fd);
+  assert(trace.open(path) == trace.INCOMPATIBLE);
+
+  // a trace cut in its last block is not read
+  assert(truncate(path, 4096) == 0);
+  assert(trace.open(path) == trace.INCOMPATIBLE);
+
+  unlink(path);
+  assert(trace.open(path) == trace.NOT_FOUND);
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib buffer with versioned slots detecting torn reads
+ */
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct versioned_policy : RTML_buffer_policy {
+  typedef RTML_versioned_slot slot_mode;
+};
+
+/*
+ * A payload wider than the native word; every word has the same value, so a
+ * torn copy has words of two different events.
+ */
+struct wide_t {
+  uint64_t word[8];
+
+  wide_t() { fill(0); }
+
+  void fill(uint64_t v) {
+    for (int i = 0; i < 8; i++)
+      word[i] = v;
+  }
+
+  bool consistent() const {
+    for (int i = 1; i < 8; i++)
+      if (word[i] != word[0])
+        return false;
+    return true;
+  }
+
+  bool operator==(const wide_t &other) const {
+    for (int i = 0; i < 8; i++)
+      if (word[i] != other.word[i])
+        return false;
+    return true;
+  }
+};
+
+typedef RTML_buffer<Event<wide_t>, 4, versioned_policy> wide_buffer_t;
+
+#ifndef NO_THREADS
+
+#include <task_compat.h>
+
+namespace versioned {
+
+const int writes = 5000;
+
+wide_buffer_t buf;
+
+std::atomic<bool> done(false);
+
+/*
+ * A slow writer that yields after each word, so that readers copy slots in
+ * the middle of a write
+ */
+void *producer(void *) {
+  for (int i = 1; i <= writes; i++) {
+    size_t index = i % buf.size;
+    Event<wide_t> &slot = buf.slot(index);
+    wide_t w = slot.getData();
+
+    buf.slot_version.begin_write(index);
+    for (int k = 0; k < 8; k++) {
+      w.word[k] = i;
+      slot.setData(w);
+      sched_yield();
+    }
+    buf.slot_version.end_write(index);
+  }
+
+  done = true;
+
+  return NULL;
+}
+
+void stress() {
+  pthread_t thread;
+  Event<wide_t> e;
+  size_t torn = 0;
+
+  assert(!pthread_create(&thread, NULL, producer, NULL));
+
+  // a read is either consistent or reported as torn
+  while (!done) {
+    for (size_t i = 0; i < buf.size; i++) {
+      if (buf.read(e, i) == buf.OK)
+        assert(e.getData().consistent());
+      else
+        torn++;
+    }
+    sched_yield();
+  }
+
+  assert(!pthread_join(thread, NULL));
+  assert(torn > 0);
+}
+
+} // namespace versioned
+
+#endif
+
+extern "C" int rtmlib_versioned_slot();
+
+int rtmlib_versioned_slot() {
+
+  static wide_buffer_t buf;
+
+  RTML_writer<wide_buffer_t> writer = RTML_writer<wide_buffer_t>(buf);
+  RTML_reader<wide_buffer_t> reader = RTML_reader<wide_buffer_t>(buf);
+
+  Event<wide_t> e, events[4];
+  wide_t w;
+
+  for (int i = 1; i <= 3; i++) {
+    w.fill(i);
+    e.setData(w);
+    assert(writer.push(e) == buf.OK);
+  }
+
+  reader.synchronize();
+
+  // a writer stopped in the middle of a slot makes the slot torn
+  buf.slot_version.begin_write(0);
+
+  assert(buf.read(e, 0) == buf.TORN);
+  assert(buf.read(events, 3, 0) == buf.TORN);
+  assert(reader.pull(e) == reader.READ_ERROR);
+
+  buf.slot_version.end_write(0);
+
+  assert(buf.read(events, 3, 0) == buf.OK);
+  for (int i = 0; i < 3; i++)
+    assert(events[i].getData().word[0] == (uint64_t)i + 1);
+
+  assert(reader.pull(e) == reader.AVAILABLE && e.getData().word[0] == 1);
+
+  // a slot reserved and not yet committed is torn too
+  Event<wide_t> &slot = writer.reserve();
+  size_t index = 3;
+  assert(buf.read(e, index) == buf.TORN);
+  w.fill(4);
+  slot.setData(w);
+  assert(writer.commit() == buf.OK);
+  assert(buf.read(e, index) == buf.OK && e.getData().word[7] == 4);
+
+#ifndef NO_THREADS
+  versioned::stress();
+#endif
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
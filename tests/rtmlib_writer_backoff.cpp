@@ -0,0 +1,137 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib page swap writers with the backoff policies
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <writer.h>
+
+struct pause_policy : RTML_buffer_policy {
+  typedef RTML_pause_backoff backoff;
+};
+
+struct exponential_policy : RTML_buffer_policy {
+  typedef RTML_exponential_backoff<16> backoff;
+};
+
+struct spin_yield_policy : RTML_buffer_policy {
+  typedef RTML_spin_yield_backoff<4> backoff;
+};
+
+#ifndef NO_THREADS
+
+#include <task_compat.h>
+
+namespace backoff {
+
+const int writers = 4;
+const int pushes = 1000;
+
+template <typename B> struct shared {
+  static B buf;
+
+  // the page of the buffer may refer to the state of any writer, so writers
+  // outlive their threads
+  static RTML_writer<B> *writer[writers];
+
+  static void *producer(void *id) {
+    RTML_writer<B> &writer = *shared::writer[(long)id];
+
+    for (int i = 0; i < pushes; i++) {
+      Event<int> e = Event<int>((long)id * pushes + i, 0);
+      writer.push(e);
+    }
+
+    return NULL;
+  }
+
+  static void concurrent() {
+    pthread_t thread[writers];
+
+    for (int i = 0; i < writers; i++)
+      writer[i] = new RTML_writer<B>(buf);
+
+    for (long i = 0; i < writers; i++)
+      assert(!pthread_create(&thread[i], NULL, producer, (void *)i));
+
+    for (int i = 0; i < writers; i++)
+      assert(!pthread_join(thread[i], NULL));
+
+    assert(buf.length() == buf.size_util);
+
+    // the trace stays monotonic and ordered per writer
+    int last[writers] = {};
+    timespan t = 0;
+    Event<int> e;
+    while (buf.pull(e) != buf.EMPTY) {
+      int w = e.getData() / pushes;
+      assert(w < writers && last[w] <= e.getData());
+      assert(e.getTime() >= t);
+      last[w] = e.getData();
+      t = e.getTime();
+    }
+  }
+};
+
+template <typename B> B shared<B>::buf;
+
+template <typename B> RTML_writer<B> *shared<B>::writer[writers];
+
+} // namespace backoff
+
+#endif
+
+extern "C" int rtmlib_writer_backoff();
+
+int rtmlib_writer_backoff() {
+
+  // the exponential backoff doubles its spins up to the maximum
+  RTML_exponential_backoff<16> exponential;
+  for (int i = 0; i < 3; i++)
+    exponential.wait();
+  assert(exponential.spins == 8);
+  for (int i = 0; i < 3; i++)
+    exponential.wait();
+  assert(exponential.spins == 16);
+
+  // the spin-then-yield backoff counts its spins before yielding
+  RTML_spin_yield_backoff<4> spin_yield;
+  for (int i = 0; i < 6; i++)
+    spin_yield.wait();
+  assert(spin_yield.waits == 4);
+
+#ifndef NO_THREADS
+  backoff::shared<RTML_buffer<Event<int>, 100>>::concurrent();
+  backoff::shared<RTML_buffer<Event<int>, 100, pause_policy>>::concurrent();
+  backoff::shared<
+      RTML_buffer<Event<int>, 100, exponential_policy>>::concurrent();
+  backoff::shared<
+      RTML_buffer<Event<int>, 100, spin_yield_policy>>::concurrent();
+#endif
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
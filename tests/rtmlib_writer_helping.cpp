@@ -0,0 +1,255 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib page swap writers completing the push of a suspended writer
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <writer.h>
+
+namespace fault {
+void suspend();
+}
+
+// a helping completion of the test only
+struct suspending_completion : RTML_help_completion {};
+
+// suspend the victim writer when it claims its slot, i.e. after it has
+// published its state and before it writes its event
+template <size_t S, size_t A>
+struct RTML_slot_claim<S, suspending_completion, A>
+    : RTML_slot_claim<S, RTML_help_completion, A> {
+  typedef RTML_slot_claim<S, RTML_help_completion, A> base_t;
+
+  int acquire(size_t index, typename base_t::tag_t k) {
+    fault::suspend();
+    return base_t::acquire(index, k);
+  }
+};
+
+struct helping_policy : RTML_buffer_policy {
+  typedef suspending_completion completion;
+};
+
+typedef RTML_buffer<Event<int>, 100, helping_policy> helping_buffer_t;
+
+#ifndef NO_THREADS
+
+#include <task_compat.h>
+
+#include <atomic>
+#include <time.h>
+
+namespace fault {
+
+const int writers = 3;
+
+std::atomic<bool> suspended(false);
+std::atomic<bool> released(false);
+thread_local bool victim = false;
+
+void suspend() {
+  if (!victim)
+    return;
+
+  suspended = true;
+  while (!released)
+    sched_yield();
+}
+
+uint64_t now() {
+  struct timespec n;
+  clock_gettime(CLOCK_MONOTONIC, &n);
+  return (uint64_t)n.tv_sec * 1000000000 + n.tv_nsec;
+}
+
+struct shared {
+  static helping_buffer_t *buf;
+
+  // the page of the buffer may refer to the state of any writer, so writers
+  // outlive their threads
+  static RTML_writer<helping_buffer_t> *writer[writers + 1];
+
+  static int pushes;
+
+  static std::atomic<uint64_t> latency;
+
+  static void *stalled(void *) {
+    victim = true;
+
+    Event<int> e = Event<int>(-1, 0);
+    writer[writers]->push(e);
+
+    return NULL;
+  }
+
+  static void *producer(void *id) {
+    RTML_writer<helping_buffer_t> &writer = *shared::writer[(long)id];
+
+    for (int i = 0; i < pushes; i++) {
+      Event<int> e = Event<int>((long)id * 1000 + i, 0);
+
+      uint64_t start = now();
+      writer.push(e);
+      uint64_t l = now() - start;
+
+      uint64_t max = latency.load();
+      while (l > max && !latency.compare_exchange_weak(max, l))
+        ;
+    }
+
+    return NULL;
+  }
+
+  // the other writers complete while the victim is suspended in its push
+  static void concurrent(int n) {
+    pthread_t victim_thread, thread[writers];
+
+    buf = new helping_buffer_t();
+    pushes = n;
+    latency = 0;
+    suspended = false;
+    released = false;
+
+    for (int i = 0; i <= writers; i++)
+      writer[i] = new RTML_writer<helping_buffer_t>(*buf);
+
+    assert(!pthread_create(&victim_thread, NULL, stalled, NULL));
+    while (!suspended)
+      sched_yield();
+
+    for (long i = 0; i < writers; i++)
+      assert(!pthread_create(&thread[i], NULL, producer, (void *)i));
+
+    for (int i = 0; i < writers; i++)
+      assert(!pthread_join(thread[i], NULL));
+
+    // a push never waits for the suspended writer (bounded by 100ms)
+    assert(latency.load() < 100000000);
+
+    released = true;
+    assert(!pthread_join(victim_thread, NULL));
+  }
+
+  static void destroy() {
+    for (int i = 0; i <= writers; i++)
+      delete writer[i];
+    delete buf;
+  }
+};
+
+helping_buffer_t *shared::buf;
+
+RTML_writer<helping_buffer_t> *shared::writer[writers + 1];
+
+int shared::pushes;
+
+std::atomic<uint64_t> shared::latency;
+
+void helping() {
+  Event<int> e;
+  int last[writers];
+
+  // the event of the victim is written by the next writer
+  shared::concurrent(30);
+
+  assert(shared::buf->length() == writers * 30 + 1);
+  assert(shared::buf->pull(e) != shared::buf->EMPTY && e.getData() == -1);
+
+  for (int w = 0; w < writers; w++)
+    last[w] = -1;
+
+  timespan t = e.getTime();
+  while (shared::buf->pull(e) != shared::buf->EMPTY) {
+    int w = e.getData() / 1000;
+    assert(w < writers && last[w] < e.getData() % 1000);
+    assert(e.getTime() >= t);
+    last[w] = e.getData() % 1000;
+    t = e.getTime();
+  }
+
+  shared::destroy();
+
+  // the victim resumes after its slot has been reused and skips its write
+  shared::concurrent(100);
+
+  assert(shared::buf->length() == shared::buf->size_util);
+  while (shared::buf->pull(e) != shared::buf->EMPTY)
+    assert(e.getData() != -1);
+
+  shared::destroy();
+}
+
+} // namespace fault
+
+#endif
+
+extern "C" int rtmlib_writer_helping();
+
+int rtmlib_writer_helping() {
+
+  static helping_buffer_t buf;
+
+  RTML_writer<helping_buffer_t> writer = RTML_writer<helping_buffer_t>(buf);
+
+  // without contention the pushes are the same as waiting ones
+  Event<int> e;
+  for (int i = 0; i < 10; i++) {
+    e.setData(i);
+    assert(writer.push(e) == buf.OK);
+  }
+
+  for (int i = 0; i < 10; i++)
+    assert(buf.pull(e) == buf.OK && e.getData() == i);
+
+  // the writer and the helpers of a push share the claim of its slot
+  RTML_slot_claim<4, RTML_help_completion> claims;
+  assert(claims.acquire(0, 1) == 1 && claims.acquire(0, 1) == 1);
+  claims.release(0);
+  claims.release(0);
+  assert(claims.acquire(0, 1) == 0);
+
+  // a helper resuming after a later lap of the ring skips its copy
+  assert(claims.acquire(0, 5) == 1 && claims.acquire(0, 1) == 0);
+  claims.release(0);
+  assert(claims.acquire(0, 1) == 0);
+
+  // a later lap waits until the copy of an older push is done
+  assert(claims.acquire(1, 2) == 1 && claims.acquire(1, 6) == -1);
+  claims.release(1);
+  assert(claims.acquire(1, 6) == 1);
+  claims.release(1);
+
+#ifndef NO_THREADS
+  fault::helping();
+#endif
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
+
+#ifdef NO_THREADS
+void fault::suspend() {}
+#endif
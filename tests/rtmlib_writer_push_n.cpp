@@ -0,0 +1,106 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib writer push of event bursts
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct push_n_ticket_policy : RTML_buffer_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+template <typename B> void push_n_and_pull() {
+  static B buf;
+
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+
+  Event<int> burst[150];
+  size_t discarded;
+
+  for (int i = 0; i < 150; i++)
+    burst[i].set(i, i);
+
+  // an empty burst does nothing
+  assert(writer.push_all_n(burst, 0, discarded) == buf.OK && discarded == 0);
+  assert(buf.length() == 0);
+
+  // 60 events fit in the buffer
+  assert(writer.push_all_n(burst, 60, discarded) == buf.OK && discarded == 0);
+  assert(buf.length() == 60);
+
+  // the next 60 events wrap around the end and overwrite 20 events
+  assert(writer.push_all_n(burst + 60, 60, discarded) == buf.BUFFER_OVERFLOW &&
+         discarded == 20);
+  assert(buf.length() == buf.size_util);
+
+  Event<int> e;
+  for (int i = 20; i < 120; i++) {
+    assert(buf.pull(e) == buf.OK);
+    assert(e.getTime() == i && e.getData() == i);
+  }
+  assert(buf.pull(e) == buf.EMPTY);
+
+  // a burst larger than the buffer keeps its last events
+  assert(writer.push_all_n(burst, 150, discarded) == buf.BUFFER_OVERFLOW &&
+         discarded == 50);
+  assert(buf.length() == buf.size_util);
+
+  for (int i = 50; i < 150; i++) {
+    assert(buf.pull(e) == buf.OK);
+    assert(e.getTime() == i && e.getData() == i);
+  }
+
+  // timestamped bursts share the same timestamp and are seen by readers
+  RTML_reader<B> reader = RTML_reader<B>(buf);
+  reader.synchronize();
+
+  assert(writer.push_n(burst, 10) == buf.OK);
+  assert(writer.push_n(burst + 10, 10) == buf.OK);
+
+  reader.synchronize();
+  assert(reader.length() == 20);
+
+  timespan t = burst[0].getTime();
+  for (int i = 0; i < 19; i++) {
+    assert(reader.pull(e) == reader.AVAILABLE);
+    assert(e.getData() == i);
+    assert(e.getTime() == (i < 10 ? t : burst[10].getTime()));
+  }
+}
+
+extern "C" int rtmlib_writer_push_n();
+
+int rtmlib_writer_push_n() {
+
+  push_n_and_pull<RTML_buffer<Event<int>, 100>>();
+
+  push_n_and_pull<RTML_buffer<Event<int>, 100, push_n_ticket_policy>>();
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
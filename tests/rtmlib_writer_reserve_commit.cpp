@@ -0,0 +1,173 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2024 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmlib writer building events in place with reserve and commit
+ */
+
+#include <assert.h>
+
+#include <circularbuffer.h>
+#include <reader.h>
+#include <writer.h>
+
+struct reserve_ticket_policy : RTML_buffer_policy {
+  typedef RTML_ticket writer_protocol;
+};
+
+#ifndef NO_THREADS
+
+#include <task_compat.h>
+
+namespace reserve_commit {
+
+const int writers = 4;
+const int pushes = 1000;
+
+template <typename B> struct shared {
+  static B buf;
+
+  // the page of the buffer may refer to the state of any writer, so writers
+  // outlive their threads
+  static RTML_writer<B> *writer[writers];
+
+  // writers alternate between reserve/commit and push
+  static void *producer(void *id) {
+    RTML_writer<B> &writer = *shared::writer[(long)id];
+
+    for (int i = 0; i < pushes; i++) {
+      if (i % 2) {
+        int data = (long)id * pushes + i;
+        Event<int> &e = writer.reserve();
+        e.setData(data);
+        writer.commit();
+      } else {
+        Event<int> e = Event<int>((long)id * pushes + i, 0);
+        writer.push(e);
+      }
+    }
+
+    return NULL;
+  }
+
+  static void concurrent() {
+    pthread_t thread[writers];
+
+    for (int i = 0; i < writers; i++)
+      writer[i] = new RTML_writer<B>(buf);
+
+    for (long i = 0; i < writers; i++)
+      assert(!pthread_create(&thread[i], NULL, producer, (void *)i));
+
+    for (int i = 0; i < writers; i++)
+      assert(!pthread_join(thread[i], NULL));
+
+    assert(buf.length() == buf.size_util);
+
+    int last[writers] = {};
+    Event<int> e;
+    while (buf.pull(e) != buf.EMPTY) {
+      int w = e.getData() / pushes;
+      assert(w < writers && last[w] <= e.getData());
+      last[w] = e.getData();
+    }
+  }
+};
+
+template <typename B> B shared<B>::buf;
+
+template <typename B> RTML_writer<B> *shared<B>::writer[writers];
+
+} // namespace reserve_commit
+
+#endif
+
+template <typename B> void reserve_and_commit() {
+  static B buf;
+
+  RTML_writer<B> writer = RTML_writer<B>(buf);
+  RTML_reader<B> reader = RTML_reader<B>(buf);
+
+  Event<int> e;
+
+  // a reserved slot is timestamped and built in place
+  for (int i = 0; i < 10; i++) {
+    Event<int> &slot = writer.reserve();
+    slot.setData(i);
+    assert(writer.commit() == buf.OK);
+  }
+  assert(buf.length() == 10);
+
+  // reserve/commit and push may be interleaved by the same writer
+  int data = 10;
+  e.setData(data);
+  assert(writer.push(e) == buf.OK);
+
+  data = 11;
+  Event<int> &slot = writer.reserve();
+  slot.setData(data);
+  assert(writer.commit() == buf.OK);
+
+  reader.synchronize();
+
+  timespan t = 0;
+  for (int i = 0; i < 11; i++) {
+    assert(reader.pull(e) == reader.AVAILABLE);
+    assert(e.getData() == i && e.getTime() >= t);
+    t = e.getTime();
+  }
+
+  // the overflow of the reservation is reported by commit
+  for (int i = 12; i < 120; i++) {
+    Event<int> &slot = writer.reserve();
+    slot.setData(i);
+    if ((size_t)i < buf.size_util)
+      assert(writer.commit() == buf.OK);
+    else
+      assert(writer.commit() == buf.BUFFER_OVERFLOW);
+  }
+
+  for (int i = 20; i < 120; i++) {
+    assert(buf.pull(e) == buf.OK);
+    assert(e.getData() == i);
+  }
+  assert(buf.pull(e) == buf.EMPTY);
+}
+
+extern "C" int rtmlib_writer_reserve_commit();
+
+int rtmlib_writer_reserve_commit() {
+
+  reserve_and_commit<RTML_buffer<Event<int>, 100>>();
+
+  reserve_and_commit<RTML_buffer<Event<int>, 100, reserve_ticket_policy>>();
+
+#ifndef NO_THREADS
+  reserve_commit::shared<RTML_buffer<Event<int>, 100>>::concurrent();
+
+  reserve_commit::shared<
+      RTML_buffer<Event<int>, 100, reserve_ticket_policy>>::concurrent();
+#endif
+
+  printf("%s \033[0;32msuccess.\e[0m\n", __FILE__);
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ *  rtmlib is a Real-Time Monitoring Library.
+ *
+ *    Copyright (C) 2018-2020 André Pedro
+ *
+ *  This file is part of rtmlib.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * rtmcheck evaluates a formula generated by rmtld3synth (RTMCHECK_FORMULA,
+ * see the Makefile) at the timestamp of each event of a trace file and
+ * prints the timeline of its verdicts and the throughput of the evaluation.
+ *
+ * usage: rtmcheck [-q] [-b events] [-j threads] [-H horizon] trace
+ *
+ *   -q          print the summary only
+ *   -b events   the number of events read ahead at a time
+ *   -j threads  the number of threads (all the processors by default)
+ *   -H horizon  the time the formula looks ahead, prefetched with a block;
+ *               it does not change the verdicts
+ *
+ * The exit status is 1 when the formula is false at some event and 2 when
+ * the trace cannot be read.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+#include <unistd.h>
+
+#include <rmtld3/offline.h>
+
+#ifndef RTMCHECK_FORMULA
+#error "RTMCHECK_FORMULA names the formula to check (see the Makefile)"
+#endif
+
+typedef Event<proposition> event_t;
+typedef RMTLD3_offline<event_t> offline_t;
+
+static double now() {
+  struct timespec n;
+  clock_gettime(CLOCK_MONOTONIC, &n);
+  return n.tv_sec + n.tv_nsec / 1e9;
+}
+
+static const char *verdict(three_valued_type v) {
+  return (v == T_TRUE) ? "true" : (v == T_FALSE) ? "false" : "unknown";
+}
+
+static void usage(const char *name) {
+  fprintf(stderr, "usage: %s [-q] [-b events] [-j threads] [-H horizon] "
+                  "trace\n",
+          name);
+}
+
+int main(int argc, char **argv) {
+  bool quiet = false;
+  size_t block = 1 << 20;
+  unsigned threads = sysconf(_SC_NPROCESSORS_ONLN);
+  timespan horizon = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "qb:j:H:")) != -1) {
+    switch (opt) {
+    case 'q':
+      quiet = true;
+      break;
+    case 'b':
+      block = strtoul(optarg, NULL, 10);
+      break;
+    case 'j':
+      threads = strtoul(optarg, NULL, 10);
+      break;
+    case 'H':
+      horizon = strtoll(optarg, NULL, 10);
+      if (horizon < 0) {
+        usage(argv[0]);
+        return 2;
+      }
+      break;
+    default:
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (optind != argc - 1) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  const char *path = argv[optind];
+  RTML_trace_buffer<event_t> trace;
+
+  switch (trace.open(path)) {
+  case trace.OPENED:
+    break;
+  case trace.NOT_FOUND:
+    fprintf(stderr, "%s: cannot open %s\n", argv[0], path);
+    return 2;
+  default:
+    fprintf(stderr, "%s: %s is not a trace of Event<proposition>\n", argv[0],
+            path);
+    return 2;
+  }
+
+  printf("# %s: %lu events", path, (unsigned long)trace.length());
+  for (size_t i = 0; i < trace.propositions(); i++) {
+    uint32_t id, length;
+    const char *name;
+    if (trace.proposition(i, id, name, length))
+      printf(" %u=%.*s", id, (int)length, name);
+  }
+  printf("\n");
+
+  unsigned long events[3] = {0, 0, 0};
+
+  double start = now();
+  size_t evaluations = offline_t(trace, block).check(
+      RTMCHECK_FORMULA<offline_t::trace_t>, 0, trace.length(),
+      [&](const RMTLD3_verdict &v) {
+        events[v.value == T_TRUE ? 0 : (v.value == T_FALSE ? 1 : 2)] +=
+            v.last - v.first + 1;
+        if (!quiet)
+          printf("[%lld, %lld] %s (events %lu to %lu)\n", (long long)v.from,
+                 (long long)v.to, verdict(v.value), (unsigned long)v.first,
+                 (unsigned long)v.last);
+      },
+      threads, horizon);
+  double seconds = now() - start;
+
+  printf("# evaluations=%lu true=%lu false=%lu unknown=%lu\n",
+         (unsigned long)evaluations, events[0], events[1], events[2]);
+  printf("# %.3fs %.0f events/s threads=%u\n", seconds,
+         (seconds > 0) ? trace.length() / seconds : 0., threads);
+
+  return (events[1] > 0) ? 1 : 0;
+}